@@ -0,0 +1,602 @@
+#include "benchmark.h"
+#include "scenariogenerator.h"
+#include "chunkedvector.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QDebug>
+#include <cmath>
+#include <random>
+
+namespace {
+
+// Valor de la opción "--nombre valor" o el valor por defecto
+QString optionValue(const QStringList& args, const QString& name, const QString& fallback)
+{
+    for (int i = 0; i + 1 < args.size(); ++i) {
+        if (args[i] == name) return args[i + 1];
+    }
+    return fallback;
+}
+
+// Nombres de las políticas del paso en la línea de comandos, en el orden
+// de los enums de Simulator
+const char* const wallPolicyNames[3] = { "reflect", "periodic", "absorb" };
+const char* const pairPolicyNames[3] = { "merge", "elastic", "none" };
+const char* const obstaclePolicyNames[3] = { "inelastic", "elastic", "none" };
+
+// Índice de "--nombre valor" en la tabla (el primero si falta), -1 si no existe
+int policyOption(const QStringList& args, const QString& name, const char* const names[3])
+{
+    QString value = optionValue(args, name, names[0]);
+    for (int k = 0; k < 3; ++k) {
+        if (value == names[k]) return k;
+    }
+    qWarning() << "Valor desconocido para" << name << ":" << value;
+    return -1;
+}
+
+// Densidad constante: separación de 10 unidades entre partículas
+double scenarioSide(int particleCount)
+{
+    return std::max(200.0, 10.0 * std::ceil(std::sqrt(static_cast<double>(particleCount))) + 20.0);
+}
+
+// FNV-1a de 64 bits sobre bytes crudos
+void hashBytes(quint64& h, const void* data, qint64 bytes)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (qint64 k = 0; k < bytes; ++k) {
+        h ^= p[k];
+        h *= 1099511628211ull;
+    }
+}
+
+// Posición en el almacén de cada ID estable
+QVector<int> slotsById(const Simulator& sim)
+{
+    const QVector<qint32>& ids = sim.getParticleIds();
+    QVector<int> slots(ids.size());
+    for (int i = 0; i < ids.size(); ++i) slots[ids[i]] = i;
+    return slots;
+}
+
+// Modelo (no medición) del tráfico de memoria de las pasadas por partícula
+// de un paso (bytes leídos + escritos por partícula, sin contar la búsqueda
+// de fusiones). Con N grande el arreglo no cabe en caché y cada pasada es un
+// viaje completo a memoria principal.
+qint64 sweepTrafficPerStep(int particleCount, bool fused, bool recording)
+{
+    const qint64 real = sizeof(SimReal);
+    const qint64 flag = sizeof(quint8);
+    const qint64 cell = sizeof(qint32);
+    const qint64 sample = recording ? sizeof(TrajectorySample) : 0;
+
+    qint64 perParticle;
+    if (fused) {
+        // x, y, vx, vy, masa, radio y activa leídos una vez; x, y, celda y
+        // muestra escritas; la muestra se copia después al registro
+        perParticle = 6 * real + flag + 2 * real + cell + 3 * sample;
+    } else {
+        perParticle = (4 * real + flag + 2 * real)      // integrar
+                      + (3 * real + flag)               // paredes
+                      + (6 * real + flag)               // obstáculos
+                      + (2 * real + flag + cell)        // rejilla
+                      + (recording ? 2 * real + flag + sample : 0);   // trayectoria
+    }
+    return perParticle * particleCount;
+}
+
+// Cuatro obstáculos como en el escenario de main.cpp, escalados a la caja
+QVector<QRectF> scenarioObstacles(double side)
+{
+    double o = side * 0.0625;
+    return { QRectF(side * 0.25, side * 0.25, o, o), QRectF(side * 0.6875, side * 0.25, o, o),
+             QRectF(side * 0.25, side * 0.6875, o, o), QRectF(side * 0.6875, side * 0.6875, o, o) };
+}
+
+// Mismo escenario para el simulador en un proceso o repartido en mosaicos
+template <typename Target>
+void fillScenario(Target& sim, int particleCount, unsigned int seed, bool shuffled)
+{
+    double side = scenarioSide(particleCount);
+    int perRow = static_cast<int>((side - 20.0) / 10.0);
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> speed(-50.0, 50.0);
+
+    for (const QRectF& r : scenarioObstacles(side)) {
+        sim.addObstacle(Obstacle(r.x(), r.y(), r.width(), r.height()));
+    }
+
+    // Sitio de la rejilla de cada partícula; barajado, el orden en memoria
+    // ya no sigue al espacial (como tras muchos pasos de simulación)
+    QVector<int> site(particleCount);
+    for (int i = 0; i < particleCount; ++i) site[i] = i;
+    if (shuffled) {
+        std::mt19937 shuffleRng(seed ^ 0x9e3779b9u);
+        std::shuffle(site.begin(), site.end(), shuffleRng);
+    }
+
+    for (int i = 0; i < particleCount; ++i) {
+        double x = 15.0 + 10.0 * (site[i] % perRow);
+        double y = 15.0 + 10.0 * (site[i] / perRow);
+        double vx = speed(rng);
+        double vy = speed(rng);
+        sim.addParticle(Particle(x, y, vx, vy, 1.0, 2.0));
+    }
+}
+
+// --tiles K: la misma corrida repartida en K procesos
+int runTiledBenchmark(const QStringList& args, int tiles)
+{
+    int particleCount = optionValue(args, "--particles", "2000").toInt();
+    double duration = optionValue(args, "--duration", "1.0").toDouble();
+    unsigned int seed = optionValue(args, "--seed", "12345").toInt();
+    QString exportFile = optionValue(args, "--export", QString());
+    const double dt = 0.01;
+
+    int walls = policyOption(args, "--walls", wallPolicyNames);
+    int pairs = policyOption(args, "--pairs", pairPolicyNames);
+    int obstacles = policyOption(args, "--obstacles", obstaclePolicyNames);
+    if (walls < 0 || pairs < 0 || obstacles < 0) {
+        return 1;
+    }
+
+    double side = scenarioSide(particleCount);
+    DomainDecomposition sim(side, side, dt, tiles);
+    buildBenchmarkScenario(sim, particleCount, seed, args.contains("--shuffle"));
+    sim.setBoundaryPolicy(static_cast<Simulator::BoundaryPolicy>(walls));
+    sim.setPairPolicy(static_cast<Simulator::PairPolicy>(pairs));
+    sim.setObstaclePolicy(static_cast<Simulator::ObstaclePolicy>(obstacles));
+
+    QElapsedTimer timer;
+    timer.start();
+    bool completed = sim.run(duration);
+    qint64 elapsedNs = timer.nsecsElapsed();
+
+    int steps = static_cast<int>(duration / dt);
+    double msPerStep = steps > 0 ? (elapsedNs / 1.0e6) / steps : 0.0;
+
+    QTextStream out(stdout);
+    out << "precision=" << simPrecisionName()
+        << " tiles=" << sim.tileCount()
+        << " walls=" << wallPolicyNames[walls]
+        << " pairs=" << pairPolicyNames[pairs]
+        << " obstacles=" << obstaclePolicyNames[obstacles]
+        << " particles=" << particleCount
+        << " steps=" << steps
+        << " total_ms=" << (elapsedNs / 1.0e6)
+        << " ms_per_step=" << msPerStep
+        << " collisions=" << sim.getCollisionCount()
+        << " completed=" << (completed ? 1 : 0)
+        << "\n";
+    out.flush();
+
+    if (!completed) {
+        return 1;
+    }
+    if (!exportFile.isEmpty() && !sim.exportToFile(exportFile)) {
+        return 1;
+    }
+    return 0;
+}
+
+// --policy-matrix: el mismo gas con cada combinación de políticas, un
+// renglón por núcleo especializado
+int runPolicyMatrix(const QStringList& args)
+{
+    int particleCount = optionValue(args, "--particles", "2000").toInt();
+    double duration = optionValue(args, "--duration", "1.0").toDouble();
+    unsigned int seed = optionValue(args, "--seed", "12345").toInt();
+    int threads = optionValue(args, "--threads", "1").toInt();
+    const double dt = 0.01;
+    const double side = scenarioSide(particleCount);
+    const int steps = static_cast<int>(duration / dt);
+
+    QTextStream out(stdout);
+    for (int walls = 0; walls < 3; ++walls) {
+        for (int pairs = 0; pairs < 3; ++pairs) {
+            for (int obstacles = 0; obstacles < 3; ++obstacles) {
+                Simulator sim(side, side, dt);
+                buildBenchmarkScenario(sim, particleCount, seed, args.contains("--shuffle"));
+                sim.setThreadCount(threads);
+                sim.setRecordTrajectories(!args.contains("--no-trajectories"));
+                sim.setFusedSweep(!args.contains("--unfused"));
+                sim.setBoundaryPolicy(static_cast<Simulator::BoundaryPolicy>(walls));
+                sim.setPairPolicy(static_cast<Simulator::PairPolicy>(pairs));
+                sim.setObstaclePolicy(static_cast<Simulator::ObstaclePolicy>(obstacles));
+
+                QElapsedTimer timer;
+                timer.start();
+                bool completed = sim.run(duration);
+                qint64 elapsedNs = timer.nsecsElapsed();
+
+                const RunStatistics& stats = sim.getStatistics();
+                out << "walls=" << wallPolicyNames[walls]
+                    << " pairs=" << pairPolicyNames[pairs]
+                    << " obstacles=" << obstaclePolicyNames[obstacles]
+                    << " particles=" << particleCount
+                    << " steps=" << steps
+                    << " ms_per_step=" << (steps > 0 ? (elapsedNs / 1.0e6) / steps : 0.0)
+                    << " walls_hit=" << stats.eventCount(WallCollision)
+                    << " obstacles_hit=" << stats.eventCount(ObstacleCollision)
+                    << " merges=" << stats.eventCount(MergeCollision)
+                    << " elastic=" << stats.eventCount(ElasticCollision)
+                    << " kinetic=" << stats.getKineticEnergy()
+                    << " completed=" << (completed ? 1 : 0)
+                    << " checksum=" << QString::number(simulationChecksum(sim), 16)
+                    << "\n";
+                out.flush();
+                if (!completed) return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// --spill-check: el volcado a disco con el presupuesto justo para un bloque
+// por registro. Un registro que empieza vacío mientras el otro agota el
+// presupuesto debe poder crecer, primero en un par de ChunkedVector y luego
+// en una corrida de una partícula
+int runSpillCheck(const QStringList& args)
+{
+    Q_UNUSED(args);
+    const int chunkBytes = 4096;
+    bool ok = true;
+
+    qint64 logged = 0;
+    qint64 events = 0;
+    qint64 spilledValues = 0;
+    {
+        MemoryArena arena(2 * chunkBytes);
+        ChunkedVector<qint64> log(&arena, chunkBytes);
+        ChunkedVector<qint64> empty(&arena, chunkBytes);
+        log.setSpillFile("verificacion_volcado_a.bin");
+        empty.setSpillFile("verificacion_volcado_b.bin");
+        ok = log.reserveFirstChunk() && empty.reserveFirstChunk();
+
+        // El primero llena varias veces su bloque; el segundo sigue vacío
+        for (qint64 k = 0; ok && k < 10 * log.chunkBytes() / qint64(sizeof(qint64)); ++k) {
+            ok = log.append(k);
+        }
+        for (qint64 k = 0; ok && k < 1000; ++k) {
+            ok = empty.append(-k);
+        }
+
+        qint64 expected = 0;
+        ok = ok && log.forEachChunk([&](const qint64* values, int count) {
+            for (int k = 0; k < count; ++k) {
+                if (values[k] != expected++) ok = false;
+            }
+        });
+        logged = log.size();
+        events = empty.size();
+        spilledValues = log.spilled();
+        ok = ok && expected == logged && events == 1000 && spilledValues > 0;
+    }
+
+    // Una partícula, presupuesto de un bloque por registro: las colisiones
+    // llegan cuando las trayectorias ya ocupan el suyo
+    Simulator sim(100, 100, 0.01);
+    sim.addParticle(Particle(50, 50, 37, 23, 1, 1));
+    sim.setMemoryBudget(2 * 64 * 1024, Simulator::SpillToDisk, "verificacion_volcado");
+    bool completed = sim.run(100.0);
+    ok = ok && completed && sim.getCollisionCount() > 0;
+
+    QTextStream out(stdout);
+    out << "spill_check=" << (ok ? "ok" : "error")
+        << " logged=" << logged
+        << " spilled=" << spilledValues
+        << " events=" << events
+        << " run_completed=" << (completed ? 1 : 0)
+        << " run_collisions=" << sim.getCollisionCount()
+        << " run_peak_bytes=" << sim.getPeakMemoryUsage()
+        << "\n";
+    out.flush();
+    return ok ? 0 : 1;
+}
+
+} // namespace
+
+void buildBenchmarkScenario(Simulator& sim, int particleCount, unsigned int seed, bool shuffled)
+{
+    fillScenario(sim, particleCount, seed, shuffled);
+}
+
+void buildBenchmarkScenario(DomainDecomposition& sim, int particleCount, unsigned int seed, bool shuffled)
+{
+    fillScenario(sim, particleCount, seed, shuffled);
+}
+
+bool writeFinalState(const Simulator& sim, const QString& filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "No se pudo abrir el archivo para escritura:" << filename;
+        return false;
+    }
+
+    QTextStream out(&file);
+    out.setRealNumberPrecision(17);
+
+    const ParticleStore& p = sim.getParticles();
+    QVector<int> slots = slotsById(sim);
+    out << "# Estado final (" << simPrecisionName() << "), t=" << sim.getCurrentTime() << "\n";
+    out << "# Formato: ID, X, Y, VX, VY, Masa, Radio, Activa\n";
+    for (int id = 0; id < p.size(); ++id) {
+        int i = slots[id];
+        out << id << "," << double(p.x[i]) << "," << double(p.y[i]) << ","
+            << double(p.vx[i]) << "," << double(p.vy[i]) << ","
+            << double(p.mass[i]) << "," << double(p.radius[i]) << ","
+            << int(p.active[i]) << "\n";
+    }
+
+    file.close();
+    return true;
+}
+
+quint64 simulationChecksum(const Simulator& sim)
+{
+    quint64 h = 14695981039346656037ull;
+    const ParticleStore& p = sim.getParticles();
+    int n = p.size();
+
+    // Columnas en orden de ID: la huella no depende del reordenamiento
+    QVector<int> slots = slotsById(sim);
+    auto hashColumn = [&](const QVector<SimReal>& column) {
+        QVector<SimReal> ordered(n);
+        for (int id = 0; id < n; ++id) ordered[id] = column[slots[id]];
+        hashBytes(h, ordered.constData(), n * sizeof(SimReal));
+    };
+    hashColumn(p.x);
+    hashColumn(p.y);
+    hashColumn(p.vx);
+    hashColumn(p.vy);
+    hashColumn(p.mass);
+    hashColumn(p.radius);
+    QVector<quint8> active(n);
+    for (int id = 0; id < n; ++id) active[id] = p.active[slots[id]];
+    hashBytes(h, active.constData(), n);
+
+    // Campo por campo: el relleno del struct no entra en la huella
+    sim.getCollisions().forEachChunk([&](const CollisionEvent* events, int count) {
+        for (int k = 0; k < count; ++k) {
+            const CollisionEvent& e = events[k];
+            hashBytes(h, &e.time, sizeof(e.time));
+            hashBytes(h, &e.kind, sizeof(e.kind));
+            hashBytes(h, &e.side, sizeof(e.side));
+            hashBytes(h, &e.particleA, sizeof(e.particleA));
+            hashBytes(h, &e.other, sizeof(e.other));
+            hashBytes(h, &e.merged, sizeof(e.merged));
+        }
+    });
+
+    return h;
+}
+
+int runBenchmarks(const QStringList& args)
+{
+    int particleCount = optionValue(args, "--particles", "2000").toInt();
+    double duration = optionValue(args, "--duration", "1.0").toDouble();
+    unsigned int seed = optionValue(args, "--seed", "12345").toInt();
+    QString stateFile = optionValue(args, "--state", QString());
+    QString exportFile = optionValue(args, "--export", QString());
+    const double dt = 0.01;
+
+    int tiles = optionValue(args, "--tiles", "1").toInt();
+    if (tiles > 1) {
+        return runTiledBenchmark(args, tiles);
+    }
+    if (args.contains("--policy-matrix")) {
+        return runPolicyMatrix(args);
+    }
+    if (args.contains("--spill-check")) {
+        return runSpillCheck(args);
+    }
+
+    int walls = policyOption(args, "--walls", wallPolicyNames);
+    int pairs = policyOption(args, "--pairs", pairPolicyNames);
+    int obstacles = policyOption(args, "--obstacles", obstaclePolicyNames);
+    if (walls < 0 || pairs < 0 || obstacles < 0) {
+        return 1;
+    }
+    QString broadphase = optionValue(args, "--broadphase", "hierarchical");
+    if (broadphase != "hierarchical" && broadphase != "uniform") {
+        qWarning() << "Valor desconocido para --broadphase :" << broadphase;
+        return 1;
+    }
+
+    // Escenario generado o cargado de condiciones iniciales binarias
+    QString scenarioFile = optionValue(args, "--scenario", QString());
+    double side = scenarioSide(particleCount);
+    if (!scenarioFile.isEmpty()) {
+        InitialConditionsFile conditions;
+        if (!conditions.open(scenarioFile)) {
+            return 1;
+        }
+        particleCount = conditions.particleCount();
+        side = conditions.boxWidth();
+    }
+
+    QElapsedTimer setupTimer;
+    setupTimer.start();
+    Simulator sim(side, side, dt);
+    if (!scenarioFile.isEmpty()) {
+        if (!sim.loadInitialConditions(scenarioFile)) {
+            return 1;
+        }
+    } else if (args.contains("--poisson")) {
+        // Misma caja, obstáculos y velocidades, posiciones de disco de Poisson
+        ScenarioSpec spec;
+        spec.particleCount = particleCount;
+        spec.boxWidth = side;
+        spec.boxHeight = side;
+        spec.obstacles = scenarioObstacles(side);
+        spec.seed = seed;
+        spec.radiusMin = optionValue(args, "--radius-min", QString::number(spec.radiusMin)).toDouble();
+        spec.radiusMax = optionValue(args, "--radius-max", QString::number(qMax(spec.radiusMin, spec.radiusMax))).toDouble();
+        ParticleStore generated;
+        if (!generateScenario(spec, generated)) {
+            return 1;
+        }
+        for (const QRectF& r : spec.obstacles) {
+            sim.addObstacle(Obstacle(r.x(), r.y(), r.width(), r.height()));
+        }
+        sim.addParticles(generated);
+    } else {
+        buildBenchmarkScenario(sim, particleCount, seed, args.contains("--shuffle"));
+    }
+    qint64 setupNs = setupTimer.nsecsElapsed();
+
+    QString saveFile = optionValue(args, "--save-scenario", QString());
+    if (!saveFile.isEmpty() && !sim.saveInitialConditions(saveFile)) {
+        return 1;
+    }
+
+    sim.setThreadCount(optionValue(args, "--threads", "1").toInt());
+    sim.setDeterministic(!args.contains("--nondeterministic"));
+    sim.setRecordTrajectories(!args.contains("--no-trajectories"));
+    sim.setFusedSweep(!args.contains("--unfused"));
+    sim.setReorderInterval(optionValue(args, "--reorder", "0").toInt());
+    sim.setBoundaryPolicy(static_cast<Simulator::BoundaryPolicy>(walls));
+    sim.setPairPolicy(static_cast<Simulator::PairPolicy>(pairs));
+    sim.setObstaclePolicy(static_cast<Simulator::ObstaclePolicy>(obstacles));
+    sim.setHierarchicalGrid(broadphase == "hierarchical");
+
+    QString statsFile = optionValue(args, "--stats", QString());
+    if (!sim.setStatisticsOutput(statsFile, optionValue(args, "--stats-every", "10").toInt())) {
+        return 1;
+    }
+
+    double budgetMb = optionValue(args, "--budget-mb", "0").toDouble();
+    if (budgetMb > 0) {
+        sim.setMemoryBudget(static_cast<qint64>(budgetMb * 1024 * 1024),
+                            args.contains("--spill") ? Simulator::SpillToDisk : Simulator::FailFast);
+    }
+
+    // Flujo en vivo opcional; capacidad holgada para las fusiones
+    QString streamName = optionValue(args, "--stream", QString());
+    StateStreamWriter stream(streamName, 2 * particleCount);
+    if (!streamName.isEmpty() && stream.open(side, side)) {
+        sim.setStateStream(&stream);
+    }
+
+    // --stop-after-merges: corrida paso a paso que se corta al llegar a N fusiones
+    int stopAfterMerges = optionValue(args, "--stop-after-merges", "0").toInt();
+    int steps = static_cast<int>(duration / dt);
+
+    QElapsedTimer timer;
+    timer.start();
+    bool completed;
+    if (stopAfterMerges > 0) {
+        int done = 0;
+        for (const StepFrame& frame : sim.steps(duration)) {
+            done++;
+            if (frame.statistics->eventCount(MergeCollision) >= stopAfterMerges) break;
+        }
+        completed = !sim.storageExhausted();
+        steps = done;
+    } else {
+        completed = sim.run(duration);
+    }
+    qint64 elapsedNs = timer.nsecsElapsed();
+
+    double msPerStep = steps > 0 ? (elapsedNs / 1.0e6) / steps : 0.0;
+
+    QTextStream out(stdout);
+    out << "precision=" << simPrecisionName()
+        << " threads=" << sim.threadCount()
+        << " deterministic=" << (sim.isDeterministic() ? 1 : 0)
+        << " particles=" << particleCount
+        << " setup_ms=" << (setupNs / 1.0e6)
+        << " steps=" << steps
+        << " total_ms=" << (elapsedNs / 1.0e6)
+        << " ms_per_step=" << msPerStep
+        << " bytes_per_particle=" << int(6 * sizeof(SimReal) + sizeof(quint8))
+        << " fused=" << (sim.isFusedSweep() ? 1 : 0)
+        << " reorder=" << sim.reorderInterval()
+        << " walls=" << wallPolicyNames[walls]
+        << " pairs=" << pairPolicyNames[pairs]
+        << " obstacles=" << obstaclePolicyNames[obstacles]
+        << " broadphase=" << broadphase
+        << " grid_levels=" << sim.gridLevels()
+        << " modeled_bytes_per_step=" << sweepTrafficPerStep(particleCount, sim.isFusedSweep(),
+                                                             sim.isRecordingTrajectories())
+        << " collisions=" << sim.getCollisionCount()
+        << " estimated_bytes=" << sim.estimateFootprint(duration)
+        << " peak_bytes=" << sim.getPeakMemoryUsage()
+        << " kinetic=" << sim.getStatistics().getKineticEnergy()
+        << " mean_free_path=" << sim.getStatistics().meanFreePath()
+        << " completed=" << (completed ? 1 : 0)
+        << " checksum=" << QString::number(simulationChecksum(sim), 16)
+        << "\n";
+    out.flush();
+
+    if (!completed) {
+        return 1;
+    }
+
+    if (!stateFile.isEmpty() && !writeFinalState(sim, stateFile)) {
+        return 1;
+    }
+    if (!exportFile.isEmpty()) {
+        sim.exportToFile(exportFile);
+    }
+    QString binaryFile = optionValue(args, "--export-binary", QString());
+    if (!binaryFile.isEmpty() && !sim.exportBinary(binaryFile)) {
+        return 1;
+    }
+    return 0;
+}
+
+int compareStates(const QString& referenceFile, const QString& otherFile)
+{
+    QFile refFile(referenceFile);
+    QFile othFile(otherFile);
+    if (!refFile.open(QIODevice::ReadOnly | QIODevice::Text) ||
+        !othFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "No se pudieron abrir los archivos de estado";
+        return 1;
+    }
+
+    QTextStream ref(&refFile);
+    QTextStream oth(&othFile);
+
+    int compared = 0;
+    int activeMismatch = 0;
+    double maxDrift = 0.0;
+    double sumSq = 0.0;
+
+    while (!ref.atEnd() && !oth.atEnd()) {
+        QString a = ref.readLine();
+        QString b = oth.readLine();
+        if (a.startsWith("#") || b.startsWith("#")) continue;
+
+        QStringList fa = a.split(',');
+        QStringList fb = b.split(',');
+        if (fa.size() < 8 || fb.size() < 8) continue;
+
+        if (fa[7].toInt() != fb[7].toInt()) {
+            activeMismatch++;
+            continue;
+        }
+        if (fa[7].toInt() == 0) continue;
+
+        double dx = fa[1].toDouble() - fb[1].toDouble();
+        double dy = fa[2].toDouble() - fb[2].toDouble();
+        double d = std::sqrt(dx * dx + dy * dy);
+        maxDrift = std::max(maxDrift, d);
+        sumSq += d * d;
+        compared++;
+    }
+
+    QTextStream out(stdout);
+    out << "compared=" << compared
+        << " max_drift=" << maxDrift
+        << " rms_drift=" << (compared > 0 ? std::sqrt(sumSq / compared) : 0.0)
+        << " active_mismatch=" << activeMismatch
+        << "\n";
+    out.flush();
+    return 0;
+}
@@ -0,0 +1,77 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "simulator.h"
+#include "domaindecomposition.h"
+#include <QStringList>
+
+// Banco de pruebas de rendimiento del simulador.
+//
+//   practica5 --bench [--particles N] [--duration T] [--seed S] [--state archivo]
+//                     [--budget-mb M [--spill]] [--stream nombre]
+//                     [--threads H] [--nondeterministic] [--tiles K] [--export archivo]
+//                     [--stats archivo [--stats-every N]] [--no-trajectories]
+//                     [--stop-after-merges N] [--unfused] [--reorder K] [--shuffle]
+//                     [--scenario archivo.p5ic] [--save-scenario archivo.p5ic]
+//                     [--export-binary archivo]
+//                     [--walls reflect|periodic|absorb] [--pairs merge|elastic|none]
+//                     [--obstacles inelastic|elastic|none] [--policy-matrix]
+//                     [--poisson [--radius-min a --radius-max b]]
+//                     [--broadphase hierarchical|uniform] [--spill-check]
+//   practica5 --watch nombre
+//   practica5 --drift referencia.txt otro.txt
+//
+// --bench ejecuta un gas reproducible y reporta el tiempo por paso en la
+// precisión con la que se compiló (double o float). --state guarda el estado
+// final para que --drift compare una corrida float contra la referencia double.
+// --budget-mb limita la memoria de datos registrados; con --spill se vuelca a
+// disco en lugar de abortar. --stream publica cada paso en memoria compartida
+// y --watch, desde otro proceso, lo muestra sin bloquear al simulador.
+// --threads reparte las fases en H hilos; la suma de verificación impresa
+// (estado final y eventos) debe coincidir entre corridas deterministas con
+// distinto número de hilos. --tiles reparte la caja en K procesos (franjas
+// verticales); con --export la exportación combinada debe ser igual a la de
+// la corrida en un solo proceso. Con --tiles, --walls admite reflect y
+// absorb y --pairs solo merge. --stats escribe la serie de tiempo de las
+// estadísticas en línea; con --no-trajectories no se guardan trayectorias.
+// --stop-after-merges recorre la corrida con Simulator::steps y la corta en
+// cuanto se alcanzan N fusiones. --unfused usa una pasada por fase en vez de
+// la pasada fusionada; modeled_bytes_per_step es el tráfico de memoria que
+// el modelo de sweepTrafficPerStep asigna a cada variante (contado a mano
+// por campo, no medido) y la suma de verificación debe coincidir entre ambas.
+// --reorder reordena las partículas en orden Z cada K pasos; --shuffle
+// inserta las partículas en orden aleatorio para medir el efecto del orden
+// en memoria. El estado final y la huella se calculan por ID estable.
+// --save-scenario guarda el gas generado como condiciones iniciales binarias
+// y --scenario lo carga en lugar de generarlo (la caja y el número de
+// partículas salen del archivo); setup_ms mide la preparación en cada caso.
+// --poisson coloca las partículas con el generador de disco de Poisson
+// (scenariogenerator.h) en vez de la rejilla regular, con radios uniformes
+// entre --radius-min y --radius-max.
+// --broadphase uniform usa una sola rejilla de celdas >= 2 * radio máximo
+// en lugar de la jerárquica; la suma de verificación debe coincidir y
+// grid_levels reporta los niveles del último paso.
+// --export-binary escribe la corrida en binario para --analyze (runanalysis.h).
+// --walls, --pairs y --obstacles eligen las políticas del paso (ver
+// Simulator::BoundaryPolicy y siguientes); --policy-matrix corre el mismo gas
+// con las 27 combinaciones y reporta un renglón por núcleo especializado.
+// --spill-check verifica el volcado a disco con el presupuesto justo para un
+// bloque por registro, con el registro de eventos vacío al agotarse; sale
+// con código 1 si algo se pierde.
+
+// Llena el simulador con un gas en rejilla y velocidades pseudoaleatorias
+// Con 'shuffled' el orden de inserción no sigue al espacial
+void buildBenchmarkScenario(Simulator& sim, int particleCount, unsigned int seed,
+                            bool shuffled = false);
+void buildBenchmarkScenario(DomainDecomposition& sim, int particleCount, unsigned int seed,
+                            bool shuffled = false);
+
+bool writeFinalState(const Simulator& sim, const QString& filename);
+
+// Huella FNV-1a del estado de las partículas y del registro de eventos
+quint64 simulationChecksum(const Simulator& sim);
+
+int runBenchmarks(const QStringList& args);
+int compareStates(const QString& referenceFile, const QString& otherFile);
+
+#endif // BENCHMARK_H
@@ -0,0 +1,47 @@
+#ifndef BINARYEXPORT_H
+#define BINARYEXPORT_H
+
+#include <QtGlobal>
+
+// Exportación binaria de una corrida (Simulator::exportBinary), pensada para
+// mapearse en memoria y recorrerse por rangos sin interpretar texto.
+//
+// Distribución (secciones alineadas a 64 bytes, en el orden de la máquina):
+//   BinaryRunHeader
+//   obstáculos    (obstacleCount x 4 double: x, y, ancho, alto)
+//   trayectorias  (sampleCount x TrajectorySample, en orden de paso)
+//   colisiones    (eventCount x CollisionEvent, en orden de registro)
+//
+// Los registros se copian tal cual de la memoria del simulador: sampleBytes
+// y eventBytes permiten rechazar un archivo de otra precisión o versión.
+
+const quint32 binaryRunMagic = 0x50355258;   // 'P5RX'
+const quint32 binaryRunVersion = 1;
+
+struct BinaryRunHeader
+{
+    quint32 magic;
+    quint32 version;
+    quint32 realSize;         // sizeof(SimReal) del escritor
+    quint32 sampleBytes;      // sizeof(TrajectorySample)
+    quint32 eventBytes;       // sizeof(CollisionEvent)
+    qint32 initialParticles;
+    double boxWidth;
+    double boxHeight;
+    double dt;
+    double restitution;
+    quint64 obstacleCount;
+    quint64 sampleCount;
+    quint64 eventCount;
+    quint64 obstaclesOffset;
+    quint64 samplesOffset;
+    quint64 eventsOffset;
+    quint64 fileBytes;
+};
+
+inline quint64 binaryRunAlign(quint64 bytes)
+{
+    return (bytes + 63) & ~quint64(63);
+}
+
+#endif // BINARYEXPORT_H
@@ -6,7 +6,7 @@ Box::Box(double w, double h)
 {
 }
 
-int Box::checkWallCollision(double x, double y, double radius) const
+int Box::checkWallCollision(SimReal x, SimReal y, SimReal radius) const
 {
     if (x - radius <= 0) return 1;        // pared izquierda
     if (x + radius >= width) return 2;     // pared derecha
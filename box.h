@@ -1,6 +1,7 @@
 #ifndef BOX_H
 #define BOX_H
 
+#include "simreal.h"
 #include <QRectF>
 
 class Box
@@ -8,16 +9,16 @@ class Box
 public:
     Box(double width, double height);
 
-    double getWidth() const { return width; }
-    double getHeight() const { return height; }
+    SimReal getWidth() const { return width; }
+    SimReal getHeight() const { return height; }
 
     // Verificar si una partícula colisiona con los bordes
     // Retorna: 0=sin colisión, 1=izquierda, 2=derecha, 3=arriba, 4=abajo
-    int checkWallCollision(double x, double y, double radius) const;
+    int checkWallCollision(SimReal x, SimReal y, SimReal radius) const;
 
 private:
-    double width;
-    double height;
+    SimReal width;
+    SimReal height;
 };
 
 #endif // BOX_H
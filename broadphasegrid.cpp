@@ -0,0 +1,76 @@
+#include "broadphasegrid.h"
+#include <algorithm>
+#include <cmath>
+
+BroadphaseGrid::BroadphaseGrid()
+    : levels(1), totalCells(1), width(1), height(1), periodic(false)
+{
+    Level single = { 0, 1, 1, 1, 1, SimReal(0.5), 0 };
+    level[0] = single;
+    cellStart.fill(0, 2);
+}
+
+void BroadphaseGrid::configure(SimReal width, SimReal height, SimReal minCell, SimReal maxDiameter,
+                               int maxCells)
+{
+    this->width = width;
+    this->height = height;
+
+    // Celdas más grandes si la caja tendría demasiadas para tan pocas partículas
+    SimReal side = std::sqrt(width * height / qMax(1, maxCells));
+    SimReal size = qMax(minCell, side);
+    if (!(size > 0)) size = qMax(width, height);
+    if (!(size > 0)) size = 1;
+
+    // Los niveles se cuentan desde arriba: el superior mide justo el
+    // diámetro máximo (o el lado fino, si es mayor) y cada uno de abajo la
+    // mitad, mientras no baje del lado fino
+    SimReal top = qMax(size, maxDiameter);
+    levels = 1;
+    while (levels < maxLevels && top / SimReal(1 << levels) >= size) levels++;
+
+    totalCells = 0;
+    for (int k = 0; k < levels; ++k) {
+        Level& g = level[k];
+        g.offset = totalCells;
+        g.cell = top / SimReal(1 << (levels - 1 - k));
+        g.inverseCell = SimReal(1) / g.cell;
+        g.cols = qMax(1, static_cast<int>(std::ceil(width * g.inverseCell)));
+        g.rows = qMax(1, static_cast<int>(std::ceil(height * g.inverseCell)));
+        g.maxRadius = g.cell / 2;
+        g.population = 0;
+        totalCells += g.cols * g.rows;
+    }
+}
+
+void BroadphaseGrid::build(const qint32* cells, int count)
+{
+    cellStart.fill(0, totalCells + 1);
+
+    int binned = 0;
+    for (int i = 0; i < count; ++i) {
+        if (cells[i] >= 0) {
+            cellStart[cells[i] + 1]++;
+            binned++;
+        }
+    }
+    for (int c = 0; c < totalCells; ++c) {
+        cellStart[c + 1] += cellStart[c];
+    }
+
+    // Las consultas se saltan los niveles vacíos
+    for (int k = 0; k < levels; ++k) {
+        int end = (k + 1 < levels) ? level[k + 1].offset : totalCells;
+        level[k].population = cellStart[end] - cellStart[level[k].offset];
+    }
+
+    // Conteo estable: los índices quedan ascendentes dentro de cada celda
+    items.resize(binned);
+    cursor.resize(cellStart.size());
+    std::copy(cellStart.constBegin(), cellStart.constEnd(), cursor.begin());
+    for (int i = 0; i < count; ++i) {
+        if (cells[i] >= 0) {
+            items[cursor[cells[i]]++] = i;
+        }
+    }
+}
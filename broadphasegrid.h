@@ -0,0 +1,168 @@
+#ifndef BROADPHASEGRID_H
+#define BROADPHASEGRID_H
+
+#include "simreal.h"
+#include <QVector>
+
+// Rejilla jerárquica para la búsqueda de parejas en contacto.
+//
+// Las fusiones hacen crecer el radio (sqrt(r1² + r2²)), así que una corrida
+// larga mezcla partículas del radio inicial con gigantes muchas veces más
+// grandes. Con un solo tamaño de celda (>= 2 * radio máximo) las celdas
+// crecen con el gigante y cada partícula pequeña termina comparándose con
+// cientos de vecinas. Aquí hay varios niveles de celdas de lado
+// base·2^k: cada partícula va al nivel más fino cuyo lado cubre su
+// diámetro, y una consulta recorre en cada nivel ocupado solo las celdas
+// que alcanza (su radio más el radio máximo de ese nivel): 3x3 o menos en
+// su nivel y en los superiores, un bloque mayor en los inferiores (lo paga
+// solo el gigante). Las celdas de todos los niveles comparten un mismo
+// índice, así que el cambio de nivel de una partícula que creció es solo
+// otro valor de cellOf en el paso siguiente.
+//
+// La celda de cada partícula se calcula en la pasada por bloques del
+// Simulator (cellOf) y build() ordena los índices por celda con un conteo
+// estable: dentro de cada celda quedan en orden ascendente, lo que permite
+// buscar la pareja (i, j) menor.
+//
+// Con paredes periódicas (setPeriodic) las consultas que pasan un borde de
+// la caja siguen por el lado opuesto en lugar de quedarse en la celda del
+// borde; la distancia la envuelve quien prueba la pareja.
+class BroadphaseGrid
+{
+public:
+    BroadphaseGrid();
+
+    static const int maxLevels = 16;
+
+    // Niveles de lado maxDiameter / 2^k, el más fino de lado >= minCell y
+    // sin pasar de maxCells celdas. Con minCell >= maxDiameter queda un solo
+    // nivel: la rejilla uniforme de siempre.
+    void configure(SimReal width, SimReal height, SimReal minCell, SimReal maxDiameter,
+                   int maxCells);
+
+    // Las coordenadas fuera de la caja se asignan a la celda del borde
+    int cellOf(SimReal x, SimReal y, SimReal radius) const
+    {
+        int k = 0;
+        while (k < levels - 1 && 2 * radius > level[k].cell) ++k;
+        const Level& g = level[k];
+        return g.offset + clampIndex(y * g.inverseCell, g.rows) * g.cols
+               + clampIndex(x * g.inverseCell, g.cols);
+    }
+
+    // Consultas que cruzan los bordes de la caja (paredes periódicas)
+    void setPeriodic(bool enabled) { periodic = enabled; }
+    bool isPeriodic() const { return periodic; }
+
+    // cells[i] < 0 = partícula fuera de la rejilla (inactiva)
+    void build(const qint32* cells, int count);
+
+    // f(const qint32* items, int count) para cada celda que puede tener una
+    // partícula en contacto con el círculo (x, y, radius), en los niveles
+    // [firstLevel, lastLevel]. Para enumerar cada pareja una sola vez basta
+    // con que cada partícula consulte su nivel y los superiores.
+    template <typename F>
+    void forEachCandidateCell(SimReal x, SimReal y, SimReal radius, F f,
+                              int firstLevel = 0, int lastLevel = maxLevels - 1) const
+    {
+        for (int k = firstLevel; k <= qMin(lastLevel, levels - 1); ++k) {
+            const Level& g = level[k];
+            if (g.population == 0) continue;
+
+            SimReal reach = radius + g.maxRadius;
+            int xs[4];
+            int ys[4];
+            int xSpans = span(x - reach, x + reach, width, g.cols, g.inverseCell, xs);
+            int ySpans = span(y - reach, y + reach, height, g.rows, g.inverseCell, ys);
+            for (int sy = 0; sy < ySpans; ++sy) {
+                for (int cy = ys[2 * sy]; cy <= ys[2 * sy + 1]; ++cy) {
+                    for (int sx = 0; sx < xSpans; ++sx) {
+                        for (int cx = xs[2 * sx]; cx <= xs[2 * sx + 1]; ++cx) {
+                            int c = g.offset + cy * g.cols + cx;
+                            int begin = cellStart[c];
+                            f(items.constData() + begin, cellStart[c + 1] - begin);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    int levelOf(int cell) const
+    {
+        int k = levels - 1;
+        while (k > 0 && cell < level[k].offset) --k;
+        return k;
+    }
+
+    int levelCount() const { return levels; }
+    int columns() const { return level[0].cols; }
+    int rowCount() const { return level[0].rows; }
+    SimReal cellSize() const { return level[0].cell; }
+
+private:
+    struct Level {
+        int offset;           // primera celda del nivel en el índice común
+        int cols;
+        int rows;
+        SimReal cell;
+        SimReal inverseCell;
+        SimReal maxRadius;    // radio máximo de las partículas del nivel
+        int population;       // partículas en el nivel tras build()
+    };
+
+    Level level[maxLevels];
+    int levels;
+    int totalCells;
+    SimReal width;
+    SimReal height;
+    bool periodic;
+    QVector<qint32> cellStart;   // totalCells + 1 desplazamientos
+    QVector<qint32> items;       // índices de partícula ordenados por celda
+    QVector<qint32> cursor;      // posición de escritura de build(), se reutiliza
+
+    static int clampIndex(SimReal f, int count)
+    {
+        return f < 0 ? 0 : (f >= count ? count - 1 : static_cast<int>(f));
+    }
+
+    // Índices [first, last] de las celdas que cubren [lo, hi] sobre un eje de
+    // largo extent: uno o dos tramos disjuntos (el segundo cuando la
+    // consulta cruza el borde de una caja periódica); devuelve cuántos
+    int span(SimReal lo, SimReal hi, SimReal extent, int count, SimReal inverseCell,
+             int* range) const
+    {
+        range[0] = clampIndex(lo * inverseCell, count);
+        range[1] = clampIndex(hi * inverseCell, count);
+        if (!periodic || (lo >= 0 && hi < extent)) return 1;
+
+        // Parte que entra por el lado opuesto; si alcanza a la otra, toda la fila
+        if (hi - lo >= extent) {
+            range[0] = 0;
+            range[1] = count - 1;
+            return 1;
+        }
+        int wrapped = (lo < 0) ? clampIndex((lo + extent) * inverseCell, count)
+                               : clampIndex((hi - extent) * inverseCell, count);
+        if (lo < 0) {
+            if (wrapped <= range[1]) {
+                range[0] = 0;
+                range[1] = count - 1;
+                return 1;
+            }
+            range[2] = wrapped;
+            range[3] = count - 1;
+        } else {
+            if (wrapped >= range[0]) {
+                range[0] = 0;
+                range[1] = count - 1;
+                return 1;
+            }
+            range[2] = 0;
+            range[3] = wrapped;
+        }
+        return 2;
+    }
+};
+
+#endif // BROADPHASEGRID_H
@@ -0,0 +1,176 @@
+#ifndef CHUNKEDVECTOR_H
+#define CHUNKEDVECTOR_H
+
+#include "memoryarena.h"
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <cstring>
+
+// Secuencia de solo-añadir almacenada en bloques de tamaño fijo tomados de
+// una MemoryArena. Los elementos nunca se mueven ni se copian al crecer.
+// Si la arena se queda sin presupuesto y hay un archivo de volcado
+// configurado, los bloques llenos se escriben a disco y se reutilizan.
+// T debe ser trivialmente copiable.
+template <typename T>
+class ChunkedVector
+{
+public:
+    explicit ChunkedVector(MemoryArena* arena, int chunkBytes = 64 * 1024)
+        : arena(arena),
+          chunkCapacity(qMax(1, chunkBytes / static_cast<int>(sizeof(T)))),
+          tailCount(0), spilledCount(0), spill(nullptr)
+    {
+    }
+
+    ~ChunkedVector()
+    {
+        clear();
+    }
+
+    // Activa el volcado a disco en la ruta dada (vacía = desactivado)
+    void setSpillFile(const QString& path) { spillPath = path; }
+
+    // Toma el primer bloque por adelantado. El volcado necesita un bloque
+    // propio que reutilizar: sin él, un vector que se queda vacío mientras
+    // otro agota el presupuesto no podría volcar nada
+    bool reserveFirstChunk()
+    {
+        if (!chunks.isEmpty()) return true;
+        T* chunk = static_cast<T*>(arena->allocateChunk(chunkBytes()));
+        if (!chunk) return false;
+        chunks.append(chunk);
+        tailCount = 0;
+        return true;
+    }
+
+    // Retorna false si no hay memoria ni volcado posible
+    bool append(const T& value)
+    {
+        if (chunks.isEmpty() || tailCount == chunkCapacity) {
+            if (!addChunk()) return false;
+        }
+        chunks.last()[tailCount++] = value;
+        return true;
+    }
+
+    // Añade 'count' elementos contiguos copiando por tramos de bloque
+    bool append(const T* values, int count)
+    {
+        while (count > 0) {
+            if (chunks.isEmpty() || tailCount == chunkCapacity) {
+                if (!addChunk()) return false;
+            }
+            int n = qMin(count, chunkCapacity - tailCount);
+            std::memcpy(chunks.last() + tailCount, values, size_t(n) * sizeof(T));
+            tailCount += n;
+            values += n;
+            count -= n;
+        }
+        return true;
+    }
+
+    qint64 size() const
+    {
+        if (chunks.isEmpty()) return spilledCount;
+        return spilledCount + qint64(chunks.size() - 1) * chunkCapacity + tailCount;
+    }
+
+    qint64 spilled() const { return spilledCount; }
+    qint64 chunkBytes() const { return qint64(chunkCapacity) * sizeof(T); }
+
+    // Recorre los elementos en orden de inserción, bloque por bloque:
+    // primero los volcados a disco y luego los que siguen en memoria.
+    // f(const T* data, int count)
+    template <typename F>
+    bool forEachChunk(F f) const
+    {
+        if (spilledCount > 0) {
+            QFile in(spillPath);
+            if (!in.open(QIODevice::ReadOnly)) return false;
+
+            QVector<T> buffer(chunkCapacity);
+            qint64 remaining = spilledCount;
+            while (remaining > 0) {
+                int count = static_cast<int>(qMin<qint64>(remaining, chunkCapacity));
+                qint64 bytes = qint64(count) * sizeof(T);
+                if (in.read(reinterpret_cast<char*>(buffer.data()), bytes) != bytes) return false;
+                f(buffer.constData(), count);
+                remaining -= count;
+            }
+        }
+
+        for (int c = 0; c < chunks.size(); ++c) {
+            int count = (c == chunks.size() - 1) ? tailCount : chunkCapacity;
+            f(chunks[c], count);
+        }
+        return true;
+    }
+
+    void clear()
+    {
+        for (T* chunk : chunks) {
+            arena->releaseChunk(chunk, chunkBytes());
+        }
+        chunks.clear();
+        tailCount = 0;
+        spilledCount = 0;
+        if (spill) {
+            spill->close();
+            QFile::remove(spillPath);
+            delete spill;
+            spill = nullptr;
+        }
+    }
+
+private:
+    MemoryArena* arena;
+    int chunkCapacity;
+    int tailCount;           // elementos usados en el último bloque
+    qint64 spilledCount;     // elementos ya escritos a disco
+    QVector<T*> chunks;
+    QString spillPath;
+    QFile* spill;
+
+    bool addChunk()
+    {
+        T* chunk = static_cast<T*>(arena->allocateChunk(chunkBytes()));
+        if (!chunk) {
+            // Sin presupuesto: volcar los bloques llenos y reutilizar el primero
+            if (spillPath.isEmpty() || chunks.isEmpty() || !spillChunks()) return false;
+            chunk = chunks.first();
+            for (int c = 1; c < chunks.size(); ++c) {
+                arena->releaseChunk(chunks[c], chunkBytes());
+            }
+            chunks.clear();
+        }
+        chunks.append(chunk);
+        tailCount = 0;
+        return true;
+    }
+
+    bool spillChunks()
+    {
+        if (!spill) {
+            spill = new QFile(spillPath);
+            if (!spill->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                delete spill;
+                spill = nullptr;
+                return false;
+            }
+        }
+
+        for (T* chunk : chunks) {
+            qint64 bytes = chunkBytes();
+            if (spill->write(reinterpret_cast<const char*>(chunk), bytes) != bytes) return false;
+        }
+        spill->flush();
+        spilledCount += qint64(chunks.size()) * chunkCapacity;
+        return true;
+    }
+
+    ChunkedVector(const ChunkedVector&);
+    ChunkedVector& operator=(const ChunkedVector&);
+};
+
+#endif // CHUNKEDVECTOR_H
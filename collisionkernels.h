@@ -0,0 +1,178 @@
+#ifndef COLLISIONKERNELS_H
+#define COLLISIONKERNELS_H
+
+#include <QRectF>
+#include <QVector>
+#include <QtGlobal>
+
+// Núcleo de colisión círculo-rectángulo compartido por Obstacle,
+// Infrastructure, Simulator y GameEngine.
+//
+// Todo se evalúa con distancias al cuadrado (sin sqrt) y sin ramas, de modo
+// que los bucles por bloques de CollisionLanes<Real>::value elementos se
+// vectorizan en el compilador. Convención de lados igual a la histórica
+// getCollisionSide: 0=arriba, 1=derecha, 2=abajo, 3=izquierda.
+
+template <typename Real>
+struct CollisionLanes
+{
+    // Elementos por registro de 256 bits (4 double u 8 float)
+    static const int value = 32 / sizeof(Real);
+};
+
+// Rectángulos empaquetados en estructura de arreglos
+template <typename Real>
+struct RectPack
+{
+    QVector<Real> left;
+    QVector<Real> top;
+    QVector<Real> right;
+    QVector<Real> bottom;
+
+    int size() const { return left.size(); }
+
+    void append(const QRectF& rect)
+    {
+        left.append(static_cast<Real>(rect.left()));
+        top.append(static_cast<Real>(rect.top()));
+        right.append(static_cast<Real>(rect.right()));
+        bottom.append(static_cast<Real>(rect.bottom()));
+    }
+
+    void clear()
+    {
+        left.clear();
+        top.clear();
+        right.clear();
+        bottom.clear();
+    }
+};
+
+// Normal de contacto (hacia fuera del rectángulo) para cada lado
+template <typename Real>
+inline void collisionSideNormal(int side, Real& nx, Real& ny)
+{
+    static const Real normalsX[4] = { 0, 1, 0, -1 };
+    static const Real normalsY[4] = { -1, 0, 1, 0 };
+    nx = normalsX[side & 3];
+    ny = normalsY[side & 3];
+}
+
+template <typename Real>
+inline Real clampReal(Real v, Real lo, Real hi)
+{
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+template <typename Real>
+inline Real absReal(Real v)
+{
+    return v < 0 ? -v : v;
+}
+
+// Prueba escalar: punto más cercano del rectángulo al centro del círculo
+template <typename Real>
+inline bool circleHitsRect(Real cx, Real cy, Real radius,
+                           Real left, Real top, Real right, Real bottom)
+{
+    Real dx = cx - clampReal(cx, left, right);
+    Real dy = cy - clampReal(cy, top, bottom);
+    return dx * dx + dy * dy < radius * radius;
+}
+
+// Lado del rectángulo más cercano al centro. En empate gana el orden
+// arriba, derecha, abajo, izquierda, igual que la versión original.
+template <typename Real>
+inline int rectCollisionSide(Real cx, Real cy,
+                             Real left, Real top, Real right, Real bottom)
+{
+    Real distTop = absReal(cy - top);
+    Real distRight = absReal(cx - right);
+    Real distBottom = absReal(cy - bottom);
+    Real distLeft = absReal(cx - left);
+
+    int side = 3;
+    Real best = distLeft;
+    side = (distBottom <= best) ? 2 : side; best = (distBottom <= best) ? distBottom : best;
+    side = (distRight <= best) ? 1 : side;  best = (distRight <= best) ? distRight : best;
+    side = (distTop <= best) ? 0 : side;
+    return side;
+}
+
+// Primer rectángulo (en orden de índice) tocado por el círculo, o -1.
+// Se evalúa un bloque completo de carriles y luego se busca el primer bit
+// de la máscara, así la prueba sigue siendo vectorial.
+template <typename Real>
+int firstCircleRectHit(Real cx, Real cy, Real radius, const RectPack<Real>& rects,
+                       int* side = nullptr)
+{
+    const int lanes = CollisionLanes<Real>::value;
+    const Real r2 = radius * radius;
+    const int n = rects.size();
+    const Real* L = rects.left.constData();
+    const Real* T = rects.top.constData();
+    const Real* R = rects.right.constData();
+    const Real* B = rects.bottom.constData();
+
+    int i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        unsigned int mask = 0;
+        for (int k = 0; k < lanes; ++k) {
+            Real dx = cx - clampReal(cx, L[i + k], R[i + k]);
+            Real dy = cy - clampReal(cy, T[i + k], B[i + k]);
+            mask |= static_cast<unsigned int>(dx * dx + dy * dy < r2) << k;
+        }
+        if (mask) {
+            int k = 0;
+            while (!(mask & (1u << k))) ++k;
+            if (side) *side = rectCollisionSide(cx, cy, L[i + k], T[i + k], R[i + k], B[i + k]);
+            return i + k;
+        }
+    }
+
+    // Resto que no llena un bloque
+    for (; i < n; ++i) {
+        if (circleHitsRect(cx, cy, radius, L[i], T[i], R[i], B[i])) {
+            if (side) *side = rectCollisionSide(cx, cy, L[i], T[i], R[i], B[i]);
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// Respuesta a un contacto círculo-rectángulo (j, side) de firstCircleRectHit.
+// Siempre corrige la posición: el centro queda a 'radius' del lado de
+// contacto, fuera del rectángulo, y si la velocidad entra al lado rebota
+// (v'⊥ = -ε v⊥), aunque el contacto venga de pasos anteriores: una
+// partícula empujada contra el lado (p. ej. por un choque con otra) no
+// queda pegada. 'contact' es la caché del rectángulo cuyo contacto ya dio
+// su evento (-1 = ninguno) y solo evita repetirlo mientras el contacto
+// dura. Retorna true en el primer rebote del contacto (un evento por
+// contacto real); un roce sin rebote todavía no cuenta.
+template <typename Real>
+inline bool resolveRectContact(Real& x, Real& y, Real& vx, Real& vy, Real radius,
+                               const RectPack<Real>& rects, int j, int side,
+                               Real restitution, qint32& contact)
+{
+    switch (side) {
+    case 0: y = rects.top[j] - radius; break;
+    case 1: x = rects.right[j] + radius; break;
+    case 2: y = rects.bottom[j] + radius; break;
+    default: x = rects.left[j] - radius; break;
+    }
+
+    const bool reported = (contact == j);
+    if (!reported) contact = -1;
+
+    Real nx, ny;
+    collisionSideNormal(side, nx, ny);
+    if (vx * nx + vy * ny >= 0) return false;
+
+    Real& normal = (side == 0 || side == 2) ? vy : vx;
+    normal = -normal * restitution;
+    contact = j;
+    return !reported;
+}
+
+#endif // COLLISIONKERNELS_H
@@ -0,0 +1,74 @@
+#include "debrislayer.h"
+#include <QPainter>
+#include <cmath>
+
+namespace {
+
+// Colores de cada jugador (los de sus bloques), con alfa premultiplicado
+const quint32 player1Color = 0xff4682b4;
+const quint32 player2Color = 0xffdc143c;
+
+} // namespace
+
+DebrisLayer::DebrisLayer(const DebrisSystem *debris, double width, double height)
+    : debris(debris), worldWidth(width), worldHeight(height), dirty(true)
+{
+    image = QImage(static_cast<int>(std::ceil(width)), static_cast<int>(std::ceil(height)),
+                   QImage::Format_ARGB32_Premultiplied);
+}
+
+void DebrisLayer::refresh()
+{
+    dirty = true;
+    update();
+}
+
+QRectF DebrisLayer::boundingRect() const
+{
+    return QRectF(0, 0, worldWidth, worldHeight);
+}
+
+void DebrisLayer::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    if (dirty) {
+        rasterize();
+        dirty = false;
+    }
+    painter->drawImage(0, 0, image);
+}
+
+void DebrisLayer::rasterize()
+{
+    image.fill(0);
+
+    const int w = image.width();
+    const int h = image.height();
+    quint32* bits = reinterpret_cast<quint32*>(image.bits());
+    const int stride = image.bytesPerLine() / 4;
+
+    const ParticleStore& p = debris->particles();
+    const QVector<quint8>& tags = debris->tags();
+    const int count = debris->highWater();
+
+    // Una sola pasada sobre los arreglos del sistema
+    for (int i = 0; i < count; ++i) {
+        if (!p.active[i]) continue;
+
+        const quint32 color = (tags[i] == 1) ? player1Color : player2Color;
+        const double r = p.radius[i];
+        int x0 = qMax(0, static_cast<int>(p.x[i] - r));
+        int x1 = qMin(w - 1, static_cast<int>(p.x[i] + r));
+        int y0 = qMax(0, static_cast<int>(p.y[i] - r));
+        int y1 = qMin(h - 1, static_cast<int>(p.y[i] + r));
+
+        for (int py = y0; py <= y1; ++py) {
+            quint32* row = bits + py * stride;
+            for (int px = x0; px <= x1; ++px) {
+                row[px] = color;
+            }
+        }
+    }
+}
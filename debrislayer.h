@@ -0,0 +1,35 @@
+#ifndef DEBRISLAYER_H
+#define DEBRISLAYER_H
+
+#include "debrissystem.h"
+#include <QGraphicsItem>
+#include <QImage>
+
+// Capa de la escena con todos los escombros: un solo QGraphicsItem que los
+// rasteriza en una QImage del tamaño del mundo (un cuadrado por pedazo,
+// escrito directo en los píxeles) y la dibuja con un drawImage, igual que
+// ParticleCanvas. Con decenas de miles de pedazos no hay un item por
+// partícula. La imagen se rehace solo después de refresh().
+class DebrisLayer : public QGraphicsItem
+{
+public:
+    DebrisLayer(const DebrisSystem *debris, double width, double height);
+
+    // Los escombros se movieron: rasterizar en el próximo paint
+    void refresh();
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+               QWidget *widget = nullptr) override;
+
+private:
+    const DebrisSystem *debris;
+    double worldWidth;
+    double worldHeight;
+    QImage image;
+    bool dirty;
+
+    void rasterize();
+};
+
+#endif // DEBRISLAYER_H
@@ -0,0 +1,233 @@
+#include "debrissystem.h"
+#include <cmath>
+
+DebrisSystem::DebrisSystem(double w, double h, int capacity)
+    : width(static_cast<SimReal>(w)), height(static_cast<SimReal>(h)),
+    ground(static_cast<SimReal>(h)), gravity(SimReal(300)), restitution(SimReal(0.35)),
+    friction(SimReal(0.85)), sleepSpeed(SimReal(4)), pieceSize(3.0),
+    slotCount(qMax(1, capacity)), cursor(0), used(0), live(0), awake(0),
+    cellSize(32.0), rng(20240611u)
+{
+    cols = qMax(1, static_cast<int>(std::ceil(w / cellSize)));
+    rows = qMax(1, static_cast<int>(std::ceil(h / cellSize)));
+    cellRects.resize(cols * rows);
+    cellBlocks.resize(cols * rows);
+}
+
+void DebrisSystem::setBlocks(const QVector<QRectF>& rects)
+{
+    for (int c = 0; c < cellRects.size(); ++c) {
+        cellRects[c].clear();
+        cellBlocks[c].clear();
+    }
+
+    // Un pedazo mide menos de pieceSize de radio: basta con ampliar cada
+    // bloque en esa medida para que su celda lo encuentre
+    for (int j = 0; j < rects.size(); ++j) {
+        const QRectF& rect = rects[j];
+        int c0 = qBound(0, static_cast<int>((rect.left() - pieceSize) / cellSize), cols - 1);
+        int c1 = qBound(0, static_cast<int>((rect.right() + pieceSize) / cellSize), cols - 1);
+        int r0 = qBound(0, static_cast<int>((rect.top() - pieceSize) / cellSize), rows - 1);
+        int r1 = qBound(0, static_cast<int>((rect.bottom() + pieceSize) / cellSize), rows - 1);
+        for (int r = r0; r <= r1; ++r) {
+            for (int c = c0; c <= c1; ++c) {
+                cellRects[r * cols + c].append(rect);
+                cellBlocks[r * cols + c].append(j);
+            }
+        }
+    }
+
+    // Los índices cambiaron: la caché de contacto ya no vale
+    contact.fill(-1);
+}
+
+void DebrisSystem::reserve()
+{
+    // Toda la memoria del sistema se reserva aquí; un motor que nunca
+    // rompe un bloque (o sin escombros) no paga por ella
+    store.resize(slotCount);
+    tag.fill(0, slotCount);
+    sleeping.fill(0, slotCount);
+    contact.fill(-1, slotCount);
+    store.active.fill(0);
+}
+
+int DebrisSystem::allocate()
+{
+    int i = cursor;
+    cursor = (cursor + 1) % slotCount;
+    used = qMax(used, i + 1);
+
+    // Al dar la vuelta se recicla el escombro más antiguo
+    if (store.active[i]) {
+        live--;
+        if (!sleeping[i]) awake--;
+    }
+    return i;
+}
+
+void DebrisSystem::shatter(const QRectF& rect, const QPointF& impactVelocity, quint8 owner)
+{
+    if (store.size() != slotCount) reserve();
+
+    const int cols = qMax(1, static_cast<int>(rect.width() / pieceSize));
+    const int rows = qMax(1, static_cast<int>(rect.height() / pieceSize));
+    const double cellW = rect.width() / cols;
+    const double cellH = rect.height() / rows;
+    const QPointF center = rect.center();
+
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const double burst = 60.0;         // rapidez máxima del estallido
+    const double carried = 0.4;        // fracción de la velocidad del impacto
+
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            const int i = allocate();
+            const double px = rect.left() + (c + 0.25 + 0.5 * unit(rng)) * cellW;
+            const double py = rect.top() + (r + 0.25 + 0.5 * unit(rng)) * cellH;
+
+            // Hacia fuera del centro, con un empujón hacia arriba
+            double dx = px - center.x();
+            double dy = py - center.y();
+            double length = std::sqrt(dx * dx + dy * dy);
+            double speed = burst * unit(rng);
+            double ux = length > 0 ? dx / length : 0.0;
+            double uy = length > 0 ? dy / length : 0.0;
+
+            store.x[i] = static_cast<SimReal>(px);
+            store.y[i] = static_cast<SimReal>(py);
+            store.vx[i] = static_cast<SimReal>(carried * impactVelocity.x() + speed * ux);
+            store.vy[i] = static_cast<SimReal>(carried * impactVelocity.y() + speed * uy - 0.5 * burst);
+            store.radius[i] = static_cast<SimReal>(0.5 * qMin(cellW, cellH));
+            store.mass[i] = static_cast<SimReal>(cellW * cellH);
+            store.active[i] = 1;
+            tag[i] = owner;
+            sleeping[i] = 0;
+            contact[i] = -1;
+            live++;
+            awake++;
+        }
+    }
+}
+
+bool DebrisSystem::update(double dt)
+{
+    if (awake == 0) return false;
+
+    const SimReal h = static_cast<SimReal>(dt);
+    SimReal* x = store.x.data();
+    SimReal* y = store.y.data();
+    SimReal* vx = store.vx.data();
+    SimReal* vy = store.vy.data();
+    const SimReal* radius = store.radius.constData();
+    const quint8* active = store.active.constData();
+    const SimReal sleep2 = sleepSpeed * sleepSpeed;
+    const SimReal inverseCell = static_cast<SimReal>(1.0 / cellSize);
+
+    // Rebotes por debajo de unos pasos de gravedad se anulan: con paso
+    // fijo, la corrección de posición al apoyarse devuelve energía y el
+    // escombro quedaría saltando sin fin
+    const SimReal settle = 4 * gravity * h;
+
+    for (int i = 0; i < used; ++i) {
+        if (!active[i] || sleeping[i]) continue;
+
+        // Integración del simulador, con la gravedad antes de mover
+        const SimReal r = radius[i];
+        vy[i] += gravity * h;
+        x[i] += vx[i] * h;
+        y[i] += vy[i] * h;
+
+        bool supported = false;
+
+        // Bloques en pie de su celda: misma respuesta que los obstáculos del
+        // simulador. Lo que la gravedad empuja contra un bloque en el que ya
+        // se apoya rebota por debajo de 'settle' y se anula, para que el
+        // escombro pueda quedar quieto encima
+        const int cx = qBound(0, static_cast<int>(x[i] * inverseCell), cols - 1);
+        const int cy = qBound(0, static_cast<int>(y[i] * inverseCell), rows - 1);
+        const RectPack<SimReal>& blocks = cellRects[cy * cols + cx];
+        int side = 0;
+        int k = blocks.size() > 0 ? firstCircleRectHit(x[i], y[i], r, blocks, &side) : -1;
+        if (k < 0) {
+            contact[i] = -1;
+        } else {
+            // La caché guarda el índice global; la respuesta usa el de la celda
+            const qint32 j = cellBlocks[cy * cols + cx][k];
+            qint32 local = (contact[i] == j) ? k : -1;
+            resolveRectContact(x[i], y[i], vx[i], vy[i], r, blocks, k, side, restitution, local);
+            contact[i] = j;
+            SimReal nx, ny;
+            collisionSideNormal(side, nx, ny);
+            if (vx[i] * nx + vy[i] * ny < 0) {
+                SimReal& normal = (side == 0 || side == 2) ? vy[i] : vx[i];
+                normal = 0;
+            }
+            if (side == 0) {
+                if (vy[i] > -settle) vy[i] = 0;
+                vx[i] *= friction;
+                supported = true;
+            }
+        }
+
+        // Paredes y techo: rebote con pérdida
+        if (x[i] - r <= 0) {
+            x[i] = r;
+            vx[i] = -vx[i] * restitution;
+        } else if (x[i] + r >= width) {
+            x[i] = width - r;
+            vx[i] = -vx[i] * restitution;
+        }
+        if (y[i] - r <= 0) {
+            y[i] = r;
+            vy[i] = -vy[i] * restitution;
+        }
+
+        // Suelo: rebote con pérdida y fricción. Va al final para que ningún
+        // pedazo termine bajo el suelo aunque un bloque lo empuje hacia abajo
+        if (y[i] + r >= ground) {
+            y[i] = ground - r;
+            if (vy[i] > 0) vy[i] = -vy[i] * restitution;
+            if (vy[i] > -settle) vy[i] = 0;
+            vx[i] *= friction;
+            supported = true;
+        }
+
+        // Quieto y apoyado: se duerme
+        if (supported && vx[i] * vx[i] + vy[i] * vy[i] < sleep2) {
+            vx[i] = 0;
+            vy[i] = 0;
+            sleeping[i] = 1;
+            awake--;
+        }
+    }
+    return awake > 0;
+}
+
+void DebrisSystem::wake(const QRectF& area)
+{
+    const SimReal left = static_cast<SimReal>(area.left());
+    const SimReal top = static_cast<SimReal>(area.top());
+    const SimReal right = static_cast<SimReal>(area.right());
+    const SimReal bottom = static_cast<SimReal>(area.bottom());
+
+    // Con holgura: un pedazo apoyado queda justo a su radio del bloque
+    for (int i = 0; i < used; ++i) {
+        if (!store.active[i] || !sleeping[i]) continue;
+        if (circleHitsRect(store.x[i], store.y[i], store.radius[i] * SimReal(1.5),
+                           left, top, right, bottom)) {
+            sleeping[i] = 0;
+            contact[i] = -1;
+            awake++;
+        }
+    }
+}
+
+void DebrisSystem::clear()
+{
+    store.active.fill(0);
+    cursor = 0;
+    used = 0;
+    live = 0;
+    awake = 0;
+}
@@ -0,0 +1,92 @@
+#ifndef DEBRISSYSTEM_H
+#define DEBRISSYSTEM_H
+
+#include "particlestore.h"
+#include "collisionkernels.h"
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+#include <random>
+
+// Escombros de los bloques destruidos. Las partículas viven en un almacén en
+// estructura de arreglos (el ParticleStore del Simulator) de capacidad fija,
+// reservado una sola vez (en el primer shatter) y usado como anillo: romper un bloque ocupa las
+// posiciones siguientes y, al dar la vuelta, recicla las de los escombros
+// más antiguos, sin reservar memoria por partícula.
+//
+// El paso es el del simulador (integración explícita y respuesta contra
+// rectángulos con firstCircleRectHit / resolveRectContact y su caché de
+// contacto) más gravedad, paredes, techo y suelo. Los bloques se reparten en
+// una rejilla de celdas y cada escombro solo se prueba contra los de su
+// celda. Un escombro que queda quieto apoyado en el suelo o en un bloque se
+// duerme y sale del bucle hasta que wake() lo despierte (cuando se rompe el
+// bloque que lo sostenía). Los escombros no chocan entre sí.
+class DebrisSystem
+{
+public:
+    DebrisSystem(double width, double height, int capacity = 32768);
+
+    void setGround(double y) { ground = static_cast<SimReal>(y); }
+    void setGravity(double g) { gravity = static_cast<SimReal>(g); }
+    void setPieceSize(double size) { pieceSize = qMax(1.0, size); }   // antes de setBlocks
+    void setRestitution(double e) { restitution = static_cast<SimReal>(e); }
+
+    // Rompe 'rect' en pedazos de ~pieceSize que salen con una fracción de la
+    // velocidad del impacto más un estallido aleatorio desde el centro.
+    // 'tag' se guarda por pedazo (el jugador dueño, para el color).
+    void shatter(const QRectF& rect, const QPointF& impactVelocity, quint8 tag);
+
+    // Bloques en pie contra los que chocan los escombros
+    void setBlocks(const QVector<QRectF>& rects);
+
+    // Avanza dt. Retorna true si queda algún escombro despierto.
+    bool update(double dt);
+
+    // Despierta los escombros que tocan 'area' (más su radio)
+    void wake(const QRectF& area);
+    void clear();
+
+    int capacity() const { return slotCount; }
+    int liveCount() const { return live; }
+    int awakeCount() const { return awake; }
+    int highWater() const { return used; }   // posiciones [0, used) en uso alguna vez
+
+    // active[i] = 1 si la posición i tiene un escombro
+    const ParticleStore& particles() const { return store; }
+    const QVector<quint8>& tags() const { return tag; }
+
+private:
+    SimReal width;
+    SimReal height;
+    SimReal ground;
+    SimReal gravity;
+    SimReal restitution;
+    SimReal friction;        // factor de la velocidad tangencial al apoyarse
+    SimReal sleepSpeed;
+    double pieceSize;
+
+    ParticleStore store;
+    QVector<quint8> tag;
+    QVector<quint8> sleeping;
+    QVector<qint32> contact;   // bloque tocado en el paso anterior (-1 = ninguno)
+    int slotCount;
+    int cursor;                // siguiente posición del anillo
+    int used;
+    int live;
+    int awake;
+
+    // Bloques por celda: rectángulos empaquetados de cada celda (ampliada
+    // por el radio máximo de un pedazo) y su índice en setBlocks
+    double cellSize;
+    int cols;
+    int rows;
+    QVector<RectPack<SimReal>> cellRects;
+    QVector<QVector<qint32>> cellBlocks;
+
+    std::mt19937 rng;
+
+    void reserve();
+    int allocate();
+};
+
+#endif // DEBRISSYSTEM_H
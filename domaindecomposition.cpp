@@ -0,0 +1,1003 @@
+#include "domaindecomposition.h"
+#include "simulator.h"
+#include "broadphasegrid.h"
+#include "collisionkernels.h"
+#include "particlestore.h"
+#include "stepkernels.h"
+#include <QFile>
+#include <QDebug>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Mensajes de tamaño fijo del protocolo coordinador <-> mosaico.
+// El protocolo avanza en orden fijo por paso, sin etiquetas de tipo.
+
+struct WireParticle
+{
+    qint32 gid;
+    qint32 contact;     // caché de contacto con obstáculo (-1 = ninguno)
+    SimReal x, y, vx, vy, mass, radius;
+};
+
+struct TileSetup
+{
+    qint32 tile;
+    qint32 tiles;
+    qint32 steps;
+    qint32 boundaryPolicy;      // Simulator::BoundaryPolicy (sin PeriodicWalls)
+    qint32 obstaclePolicy;      // Simulator::ObstaclePolicy
+    qint32 reserved;
+    double dt;
+    double boxWidth;
+    double boxHeight;
+};
+
+struct MergeCandidate
+{
+    qint32 first;       // -1 si el mosaico no encontró pareja
+    qint32 second;
+    SimReal maxRadius;  // radio máximo de sus partículas
+};
+
+struct MergeDecision
+{
+    qint32 first;
+    qint32 second;
+    qint32 mergedGid;
+    qint32 reserved;
+};
+
+// Cierre del paso de cada mosaico: sus sumas para RunStatistics y, en el
+// mosaico que fusionó, la pareja y la partícula nueva
+struct MergeReport
+{
+    qint32 done;        // 1 en el mosaico que creó la partícula fusionada
+    qint32 walls;       // eventos del paso en el mosaico
+    qint32 obstacles;
+    qint32 reserved;
+    StepTally tally;    // partículas propias antes de la fusión
+    WireParticle a;
+    WireParticle b;
+    WireParticle merged;
+};
+
+struct TileTotals
+{
+    qint64 samples;
+    qint64 events;
+};
+
+// Franja dueña de la coordenada x (los extremos se extienden al infinito)
+int tileFor(SimReal x, double boxWidth, int tiles)
+{
+    int t = static_cast<int>(std::floor(x / (boxWidth / tiles)));
+    return std::max(0, std::min(tiles - 1, t));
+}
+
+// Intervalo [lo, hi) de la franja, ampliado por el halo
+void tileRange(int t, double boxWidth, int tiles, double halo, double& lo, double& hi)
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    double w = boxWidth / tiles;
+    lo = (t == 0) ? -inf : t * w - halo;
+    hi = (t == tiles - 1) ? inf : (t + 1) * w + halo;
+}
+
+#ifdef Q_OS_UNIX
+
+bool writeAll(int fd, const void* data, qint64 bytes)
+{
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t n = ::write(fd, p, static_cast<size_t>(bytes));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        bytes -= n;
+    }
+    return true;
+}
+
+bool readAll(int fd, void* data, qint64 bytes)
+{
+    char* p = static_cast<char*>(data);
+    while (bytes > 0) {
+        ssize_t n = ::read(fd, p, static_cast<size_t>(bytes));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        bytes -= n;
+    }
+    return true;
+}
+
+template <typename T>
+bool sendValue(int fd, const T& value)
+{
+    return writeAll(fd, &value, sizeof(T));
+}
+
+template <typename T>
+bool recvValue(int fd, T& value)
+{
+    return readAll(fd, &value, sizeof(T));
+}
+
+template <typename T>
+bool sendVector(int fd, const QVector<T>& v)
+{
+    qint64 n = v.size();
+    return sendValue(fd, n) && writeAll(fd, v.constData(), n * qint64(sizeof(T)));
+}
+
+template <typename T>
+bool recvVector(int fd, QVector<T>& v)
+{
+    qint64 n = 0;
+    if (!recvValue(fd, n)) return false;
+    v.resize(static_cast<int>(n));
+    return readAll(fd, v.data(), n * qint64(sizeof(T)));
+}
+
+WireParticle toWire(const ParticleStore& p, const QVector<qint32>& gids, int i, qint32 contact = -1)
+{
+    WireParticle w = { gids[i], contact, p.x[i], p.y[i], p.vx[i], p.vy[i], p.mass[i], p.radius[i] };
+    return w;
+}
+
+WireParticle toWire(const Particle& p, qint32 gid)
+{
+    QPointF pos = p.getPosition();
+    QPointF vel = p.getVelocity();
+    WireParticle w = { gid, -1, SimReal(pos.x()), SimReal(pos.y()), SimReal(vel.x()), SimReal(vel.y()),
+                       SimReal(p.getMass()), SimReal(p.getRadius()) };
+    return w;
+}
+
+Particle fromWire(const WireParticle& w)
+{
+    return Particle(w.x, w.y, w.vx, w.vy, w.mass, w.radius);
+}
+
+// Las partículas propias guardan también su caché de contacto
+void appendWire(ParticleStore& p, QVector<qint32>& gids, const WireParticle& w,
+                QVector<qint32>* contacts = nullptr)
+{
+    p.x.append(w.x);
+    p.y.append(w.y);
+    p.vx.append(w.vx);
+    p.vy.append(w.vy);
+    p.mass.append(w.mass);
+    p.radius.append(w.radius);
+    p.active.append(1);
+    gids.append(w.gid);
+    if (contacts) contacts->append(w.contact);
+}
+
+// Conserva las partículas con keep[i] != 0, en el mismo orden
+void compact(ParticleStore& p, QVector<qint32>& gids, QVector<qint32>& contacts,
+             const QVector<quint8>& keep)
+{
+    int out = 0;
+    for (int i = 0; i < p.size(); ++i) {
+        if (!keep[i]) continue;
+        p.x[out] = p.x[i];
+        p.y[out] = p.y[i];
+        p.vx[out] = p.vx[i];
+        p.vy[out] = p.vy[i];
+        p.mass[out] = p.mass[i];
+        p.radius[out] = p.radius[i];
+        p.active[out] = 1;
+        gids[out] = gids[i];
+        contacts[out] = contacts[i];
+        out++;
+    }
+    p.x.resize(out);
+    p.y.resize(out);
+    p.vx.resize(out);
+    p.vy.resize(out);
+    p.mass.resize(out);
+    p.radius.resize(out);
+    p.active.resize(out);
+    gids.resize(out);
+    contacts.resize(out);
+}
+
+// Proceso hijo: una franja de la caja
+class DomainTile
+{
+public:
+    DomainTile(int socket, const TileSetup& setup, const QVector<QRectF>& obstacleRects,
+               const QString& trajectoryPath, const QString& eventPath)
+        : fd(socket), setup(setup), trajectoryFile(trajectoryPath), eventFile(eventPath),
+          samples(0), events(0)
+    {
+        for (const QRectF& r : obstacleRects) {
+            obstacles.append(r);
+        }
+    }
+
+    int serve()
+    {
+        if (!recvInitial()) return 1;
+        if (!trajectoryFile.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+            !eventFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            return 1;
+        }
+
+        for (int s = 0; s < setup.steps; ++s) {
+            if (!step(s)) return 1;
+        }
+
+        trajectoryFile.close();
+        eventFile.close();
+
+        TileTotals totals = { samples, events };
+        return sendValue(fd, totals) ? 0 : 1;
+    }
+
+private:
+    int fd;
+    TileSetup setup;
+    RectPack<SimReal> obstacles;
+    QFile trajectoryFile;
+    QFile eventFile;
+    qint64 samples;
+    qint64 events;
+
+    ParticleStore owned;
+    QVector<qint32> ownedGid;
+    QVector<qint32> ownedContact;   // como Simulator::obstacleContact
+    ParticleStore ghosts;
+    QVector<qint32> ghostGid;
+    QVector<CollisionEvent> stepEvents;
+    StepTally stepTally;
+
+    // Búsqueda de la fusión: propias y fantasmas juntas, en coordenadas de
+    // la franja (se reutilizan de un paso al siguiente)
+    BroadphaseGrid grid;
+    QVector<SimReal> pairX;
+    QVector<SimReal> pairY;
+    QVector<SimReal> pairRadius;
+    QVector<qint32> pairGid;
+    QVector<qint32> pairCell;
+
+    bool recvInitial()
+    {
+        QVector<WireParticle> initial;
+        if (!recvVector(fd, initial)) return false;
+        for (const WireParticle& w : initial) {
+            appendWire(owned, ownedGid, w, &ownedContact);
+        }
+        return true;
+    }
+
+    bool step(int s)
+    {
+        const double time = s * setup.dt;
+        stepEvents.clear();
+
+        integrateAndCollide(time);
+        if (!exchangeMigrants()) return false;
+
+        SimReal halo = 0;
+        if (!recvValue(fd, halo) || !exchangeHalo(halo)) return false;
+        if (!resolveMerge(halo)) return false;
+
+        return recordStep(s);
+    }
+
+    // Movimiento, paredes y obstáculos con los núcleos de Simulator
+    // (stepkernels.h), con IDs globales
+    void integrateAndCollide(double time)
+    {
+        if (setup.boundaryPolicy == Simulator::AbsorbWalls) {
+            selectObstacles<AbsorbBoundary>(time);
+        } else {
+            selectObstacles<ReflectBoundary>(time);
+        }
+    }
+
+    template <class Boundary>
+    void selectObstacles(double time)
+    {
+        switch (setup.obstaclePolicy) {
+        case Simulator::ElasticObstacles:
+            sweep<Boundary, ElasticResponse>(time);
+            break;
+        case Simulator::IgnoreObstacles:
+            sweep<Boundary, NoResponse>(time);
+            break;
+        default:
+            sweep<Boundary, InelasticResponse>(time);
+            break;
+        }
+    }
+
+    // Las fases en el orden de las pasadas separadas de Simulator; los
+    // eventos del paso se ordenan después, así que no cambia la salida
+    template <class Boundary, class Obstacles>
+    void sweep(double time)
+    {
+        const SimReal h = static_cast<SimReal>(setup.dt);
+        const SimReal width = static_cast<SimReal>(setup.boxWidth);
+        const SimReal height = static_cast<SimReal>(setup.boxHeight);
+        ParticleColumns p(owned, ownedGid, ownedContact);
+        StepTally& tally = stepTally;
+        tally = StepTally();
+
+        const int n = owned.size();
+        for (int i = 0; i < n; ++i) {
+            integrateOne(p, i, h, tally);
+        }
+        for (int i = 0; i < n; ++i) {
+            int wall = Boundary::apply(p, i, width, height);
+            if (wall) logWall(p, i, wall, time, stepEvents);
+        }
+        for (int i = 0; i < n; ++i) {
+            if (Boundary::absorbs && !p.active[i]) continue;
+            collideWithObstacles<Obstacles>(p, i, obstacles, time, stepEvents, tally);
+            tallyParticle(p, i, tally);
+        }
+
+        // Las absorbidas dejan de existir en el mosaico
+        if (Boundary::absorbs) {
+            QVector<quint8> keep = owned.active;
+            compact(owned, ownedGid, ownedContact, keep);
+        }
+    }
+
+    bool exchangeMigrants()
+    {
+        QVector<WireParticle> emigrants;
+        QVector<quint8> keep(owned.size(), 1);
+        for (int i = 0; i < owned.size(); ++i) {
+            if (tileFor(owned.x[i], setup.boxWidth, setup.tiles) != setup.tile) {
+                emigrants.append(toWire(owned, ownedGid, i, ownedContact[i]));
+                keep[i] = 0;
+            }
+        }
+        if (!emigrants.isEmpty()) compact(owned, ownedGid, ownedContact, keep);
+
+        QVector<WireParticle> immigrants;
+        if (!sendVector(fd, emigrants) || !recvVector(fd, immigrants)) return false;
+        for (const WireParticle& w : immigrants) {
+            appendWire(owned, ownedGid, w, &ownedContact);
+        }
+        return true;
+    }
+
+    bool exchangeHalo(SimReal halo)
+    {
+        // Propias cerca de un borde interior: el coordinador decide a quién van
+        double w = setup.boxWidth / setup.tiles;
+        double lo = setup.tile * w + halo;
+        double hi = (setup.tile + 1) * w - halo;
+
+        QVector<WireParticle> border;
+        for (int i = 0; i < owned.size(); ++i) {
+            bool nearLeft = setup.tile > 0 && owned.x[i] < lo;
+            bool nearRight = setup.tile < setup.tiles - 1 && owned.x[i] >= hi;
+            if (nearLeft || nearRight) border.append(toWire(owned, ownedGid, i));
+        }
+
+        QVector<WireParticle> incoming;
+        if (!sendVector(fd, border) || !recvVector(fd, incoming)) return false;
+
+        ghosts = ParticleStore();
+        ghostGid.clear();
+        for (const WireParticle& g : incoming) {
+            appendWire(ghosts, ghostGid, g);
+        }
+        return true;
+    }
+
+    // Pareja (IDs globales) lexicográficamente menor vista por este mosaico,
+    // con al menos una propia. Propias y fantasmas van a una rejilla
+    // jerárquica sobre la franja con su halo y, como en
+    // Simulator::findMergePair, cada partícula consulta su nivel y los
+    // superiores: cada pareja sale de la más pequeña (las fantasmas también
+    // consultan) y un gigante no recorre los niveles finos
+    MergeCandidate findCandidate(SimReal halo)
+    {
+        MergeCandidate best = { -1, -1, 0 };
+        const int n = owned.size();
+        const int total = n + ghosts.size();
+        if (total == 0) return best;
+
+        const double stripWidth = setup.boxWidth / setup.tiles;
+        const SimReal originX = SimReal(setup.tile * stripWidth) - halo;
+        pairX.resize(total);
+        pairY.resize(total);
+        pairRadius.resize(total);
+        pairGid.resize(total);
+        pairCell.resize(total);
+
+        SimReal minRadius = std::numeric_limits<SimReal>::max();
+        SimReal maxRadius = 0;
+        for (int k = 0; k < total; ++k) {
+            const bool own = k < n;
+            const ParticleStore& p = own ? owned : ghosts;
+            const int i = own ? k : k - n;
+            pairX[k] = p.x[i] - originX;
+            pairY[k] = p.y[i];
+            pairRadius[k] = p.radius[i];
+            pairGid[k] = own ? ownedGid[i] : ghostGid[i];
+            minRadius = qMin(minRadius, p.radius[i]);
+            maxRadius = qMax(maxRadius, p.radius[i]);
+            if (own) best.maxRadius = qMax(best.maxRadius, p.radius[i]);
+        }
+
+        // Lo que quede fuera de la franja cae en las celdas del borde
+        grid.configure(SimReal(stripWidth) + 2 * halo, SimReal(setup.boxHeight), 2 * minRadius,
+                       2 * maxRadius, qMax(64, 2 * total));
+        for (int k = 0; k < total; ++k) {
+            pairCell[k] = grid.cellOf(pairX[k], pairY[k], pairRadius[k]);
+        }
+        grid.build(pairCell.constData(), total);
+
+        quint64 bestKey = ~quint64(0);
+        for (int a = 0; a < total; ++a) {
+            const bool ownedA = a < n;
+            const int level = grid.levelOf(pairCell[a]);
+            auto test = [&](const qint32* items, int count, bool sameLevel) {
+                for (int k = 0; k < count; ++k) {
+                    const int b = items[k];
+                    // En su nivel cada pareja sale una vez; fantasma-fantasma
+                    // es de otro mosaico
+                    if (sameLevel && b <= a) continue;
+                    if (!ownedA && b >= n) continue;
+
+                    quint64 key = (quint64(qMin(pairGid[a], pairGid[b])) << 32)
+                                  | quint64(qMax(pairGid[a], pairGid[b]));
+                    if (key >= bestKey) continue;
+
+                    SimReal dx = pairX[a] - pairX[b];
+                    SimReal dy = pairY[a] - pairY[b];
+                    SimReal sumR = pairRadius[a] + pairRadius[b];
+                    if (dx * dx + dy * dy < sumR * sumR) bestKey = key;
+                }
+            };
+            grid.forEachCandidateCell(pairX[a], pairY[a], pairRadius[a],
+                                      [&](const qint32* items, int count) {
+                                          test(items, count, true);
+                                      }, level, level);
+            grid.forEachCandidateCell(pairX[a], pairY[a], pairRadius[a],
+                                      [&](const qint32* items, int count) {
+                                          test(items, count, false);
+                                      }, level + 1);
+        }
+
+        if (bestKey != ~quint64(0)) {
+            best.first = static_cast<qint32>(bestKey >> 32);
+            best.second = static_cast<qint32>(bestKey & 0xffffffffu);
+        }
+        return best;
+    }
+
+    bool resolveMerge(SimReal halo)
+    {
+        MergeDecision decision;
+        if (!sendValue(fd, findCandidate(halo)) || !recvValue(fd, decision)) return false;
+
+        MergeReport report = {};
+        report.tally = stepTally;
+        for (const CollisionEvent& event : stepEvents) {
+            if (event.kind == WallCollision) report.walls++;
+            else if (event.kind == ObstacleCollision) report.obstacles++;
+        }
+
+        if (decision.first >= 0) {
+            int a = ownedGid.indexOf(decision.first);
+            int b = ownedGid.indexOf(decision.second);
+
+            if (a >= 0) {
+                // Este mosaico crea la partícula fusionada (la segunda puede ser fantasma)
+                Particle second = (b >= 0) ? owned.get(b) : ghosts.get(ghostGid.indexOf(decision.second));
+                Particle merged = Particle::merge(owned.get(a), second);
+
+                report.done = 1;
+                report.a = toWire(owned, ownedGid, a);
+                report.b = toWire(second, decision.second);
+                report.merged = toWire(merged, decision.mergedGid);
+                appendWire(owned, ownedGid, report.merged, &ownedContact);
+            }
+
+            if (a >= 0 || b >= 0) {
+                QVector<quint8> keep(owned.size(), 1);
+                if (a >= 0) keep[a] = 0;
+                if (b >= 0) keep[b] = 0;
+                compact(owned, ownedGid, ownedContact, keep);
+            }
+        }
+
+        return sendValue(fd, report);
+    }
+
+    // Bloque del paso: muestras ordenadas por ID y eventos por (tipo, ID)
+    bool recordStep(int s)
+    {
+        QVector<int> order(owned.size());
+        for (int i = 0; i < order.size(); ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [this](int a, int b) {
+            return ownedGid[a] < ownedGid[b];
+        });
+
+        QVector<TrajectorySample> block(order.size());
+        for (int k = 0; k < order.size(); ++k) {
+            int i = order[k];
+            TrajectorySample sample = { s, ownedGid[i], owned.x[i], owned.y[i] };
+            block[k] = sample;
+        }
+
+        std::stable_sort(stepEvents.begin(), stepEvents.end(),
+                         [](const CollisionEvent& a, const CollisionEvent& b) {
+                             if (a.kind != b.kind) return a.kind < b.kind;
+                             if (a.particleA != b.particleA) return a.particleA < b.particleA;
+                             return a.other < b.other;
+                         });
+
+        qint32 header[2] = { s, block.size() };
+        qint32 eventHeader[2] = { s, stepEvents.size() };
+        samples += block.size();
+        events += stepEvents.size();
+
+        return trajectoryFile.write(reinterpret_cast<const char*>(header), sizeof(header)) == sizeof(header)
+            && trajectoryFile.write(reinterpret_cast<const char*>(block.constData()),
+                                    block.size() * qint64(sizeof(TrajectorySample))) == block.size() * qint64(sizeof(TrajectorySample))
+            && eventFile.write(reinterpret_cast<const char*>(eventHeader), sizeof(eventHeader)) == sizeof(eventHeader)
+            && eventFile.write(reinterpret_cast<const char*>(stepEvents.constData()),
+                               stepEvents.size() * qint64(sizeof(CollisionEvent))) == stepEvents.size() * qint64(sizeof(CollisionEvent));
+    }
+};
+
+#endif // Q_OS_UNIX
+
+} // namespace
+
+DomainDecomposition::DomainDecomposition(double w, double h, double deltaT, int tileCount)
+    : boxWidth(w), boxHeight(h), dt(deltaT), tiles(qMax(1, tileCount)),
+    boundaryPolicy(Simulator::ReflectWalls), pairPolicy(Simulator::MergePairs),
+    obstaclePolicy(Simulator::InelasticObstacles),
+    initialCount(0), steps(0), collisionCount(0)
+{
+}
+
+DomainDecomposition::~DomainDecomposition()
+{
+    stopTiles();
+    removeShards();
+}
+
+void DomainDecomposition::addParticle(const Particle& particle)
+{
+    initialParticles.append(particle);
+    initialCount++;
+}
+
+void DomainDecomposition::addObstacle(const Obstacle& obstacle)
+{
+    obstacles.append(obstacle);
+}
+
+QString DomainDecomposition::trajectoryShard(int tile) const
+{
+    return QString("%1_%2_trayectorias.bin").arg(shardPrefix).arg(tile);
+}
+
+QString DomainDecomposition::eventShard(int tile) const
+{
+    return QString("%1_%2_colisiones.bin").arg(shardPrefix).arg(tile);
+}
+
+QString DomainDecomposition::mergeShard() const
+{
+    return QString("%1_fusiones.bin").arg(shardPrefix);
+}
+
+void DomainDecomposition::removeShards()
+{
+    if (shardPrefix.isEmpty()) return;
+    for (int t = 0; t < tiles; ++t) {
+        QFile::remove(trajectoryShard(t));
+        QFile::remove(eventShard(t));
+    }
+    QFile::remove(mergeShard());
+}
+
+#ifdef Q_OS_UNIX
+
+bool DomainDecomposition::startTiles()
+{
+    QVector<QRectF> rects;
+    for (const Obstacle& o : obstacles) rects.append(o.getRect());
+
+    std::fflush(stdout);
+    std::fflush(stderr);
+
+    for (int t = 0; t < tiles; ++t) {
+        int pair[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+            qWarning() << "No se pudo crear el socket del mosaico" << t;
+            return false;
+        }
+
+        pid_t pid = ::fork();
+        if (pid < 0) {
+            ::close(pair[0]);
+            ::close(pair[1]);
+            qWarning() << "No se pudo crear el proceso del mosaico" << t;
+            return false;
+        }
+
+        if (pid == 0) {
+            // Proceso hijo: solo conserva su extremo del socket
+            ::close(pair[0]);
+            for (int fd : sockets) ::close(fd);
+            initialParticles = QVector<Particle>();
+
+            TileSetup setup = { t, tiles, steps, boundaryPolicy, obstaclePolicy, 0,
+                                dt, boxWidth, boxHeight };
+            DomainTile tile(pair[1], setup, rects, trajectoryShard(t), eventShard(t));
+            int code = tile.serve();
+            ::close(pair[1]);
+            ::_exit(code);
+        }
+
+        ::close(pair[1]);
+        sockets.append(pair[0]);
+        pids.append(pid);
+    }
+    return true;
+}
+
+void DomainDecomposition::stopTiles()
+{
+    for (int fd : sockets) ::close(fd);
+    for (qint64 pid : pids) {
+        int status = 0;
+        ::waitpid(static_cast<pid_t>(pid), &status, 0);
+    }
+    sockets.clear();
+    pids.clear();
+}
+
+bool DomainDecomposition::run(double duration, const QString& prefix)
+{
+    // Las franjas no se envuelven ni intercambian choques elásticos
+    if (boundaryPolicy == Simulator::PeriodicWalls || pairPolicy != Simulator::MergePairs) {
+        qWarning() << "La simulación por mosaicos solo admite paredes reflect/absorb y"
+                   << "parejas merge; corrida no iniciada.";
+        return false;
+    }
+
+    removeShards();
+    shardPrefix = prefix;
+    steps = static_cast<int>(duration / dt);
+    collisionCount = 0;
+
+    qDebug() << "Ejecutando simulación en" << tiles << "mosaicos con" << steps << "pasos...";
+
+    if (!startTiles()) {
+        stopTiles();
+        return false;
+    }
+
+    // Repartir las partículas iniciales y liberar la copia del coordinador
+    QVector<QVector<WireParticle>> initial(tiles);
+    SimReal maxRadius = 0;
+    for (int i = 0; i < initialParticles.size(); ++i) {
+        const Particle& p = initialParticles[i];
+        QPointF pos = p.getPosition();
+        QPointF vel = p.getVelocity();
+        WireParticle w = { i, -1, SimReal(pos.x()), SimReal(pos.y()), SimReal(vel.x()), SimReal(vel.y()),
+                           SimReal(p.getMass()), SimReal(p.getRadius()) };
+        initial[tileFor(w.x, boxWidth, tiles)].append(w);
+        maxRadius = qMax(maxRadius, w.radius);
+    }
+    initialParticles = QVector<Particle>();
+
+    bool ok = true;
+    for (int t = 0; t < tiles && ok; ++t) {
+        ok = sendVector(sockets[t], initial[t]);
+    }
+    initial.clear();
+
+    QFile merges(mergeShard());
+    ok = ok && merges.open(QIODevice::WriteOnly | QIODevice::Truncate);
+
+    qint32 nextGid = initialCount;
+    QVector<WireParticle> incoming;
+    QVector<QVector<WireParticle>> routed(tiles);
+
+    for (int s = 0; s < steps && ok; ++s) {
+        // 1. Migración: cada partícula va a la franja que contiene su centro
+        for (int t = 0; t < tiles; ++t) routed[t].clear();
+        for (int t = 0; t < tiles && ok; ++t) {
+            ok = recvVector(sockets[t], incoming);
+            for (const WireParticle& w : incoming) {
+                routed[tileFor(w.x, boxWidth, tiles)].append(w);
+            }
+        }
+
+        // 2. Halo: 2 * radio máximo cubre cualquier pareja que se toque
+        SimReal halo = 2 * maxRadius;
+        for (int t = 0; t < tiles && ok; ++t) {
+            ok = sendVector(sockets[t], routed[t]) && sendValue(sockets[t], halo);
+        }
+
+        for (int t = 0; t < tiles; ++t) routed[t].clear();
+        for (int t = 0; t < tiles && ok; ++t) {
+            ok = recvVector(sockets[t], incoming);
+            for (const WireParticle& w : incoming) {
+                for (int u = 0; u < tiles; ++u) {
+                    double lo, hi;
+                    tileRange(u, boxWidth, tiles, halo, lo, hi);
+                    if (u != t && w.x >= lo && w.x < hi) routed[u].append(w);
+                }
+            }
+        }
+        for (int t = 0; t < tiles && ok; ++t) {
+            ok = sendVector(sockets[t], routed[t]);
+        }
+
+        // 3. Fusión: la pareja global menor, con el siguiente ID global
+        MergeDecision decision = { -1, -1, -1, 0 };
+        quint64 bestKey = ~quint64(0);
+        for (int t = 0; t < tiles && ok; ++t) {
+            MergeCandidate c;
+            ok = recvValue(sockets[t], c);
+            if (!ok) break;
+            maxRadius = qMax(maxRadius, c.maxRadius);
+            if (c.first < 0) continue;
+            quint64 key = (quint64(c.first) << 32) | quint64(c.second);
+            if (key < bestKey) {
+                bestKey = key;
+                decision.first = c.first;
+                decision.second = c.second;
+            }
+        }
+        if (decision.first >= 0) decision.mergedGid = nextGid++;
+
+        for (int t = 0; t < tiles && ok; ++t) {
+            ok = sendValue(sockets[t], decision);
+        }
+        for (int t = 0; t < tiles && ok; ++t) {
+            MergeReport report;
+            ok = recvValue(sockets[t], report);
+            if (!ok) break;
+
+            // Mismo ciclo de RunStatistics que Simulator::step
+            statistics.addTally(report.tally);
+            for (int k = 0; k < report.walls; ++k) statistics.countEvent(WallCollision);
+            for (int k = 0; k < report.obstacles; ++k) statistics.countEvent(ObstacleCollision);
+            if (!report.done) continue;
+
+            statistics.countEvent(MergeCollision);
+            statistics.addMerge(fromWire(report.a), fromWire(report.b), fromWire(report.merged));
+            maxRadius = qMax(maxRadius, report.merged.radius);
+
+            CollisionEvent event = {};
+            event.time = s * dt;
+            event.kind = MergeCollision;
+            event.particleA = decision.first;
+            event.other = decision.second;
+            event.merged = decision.mergedGid;
+            event.massA = report.a.mass;
+            event.massB = report.b.mass;
+            event.mergedMass = report.merged.mass;
+            qint32 step = s;
+            ok = merges.write(reinterpret_cast<const char*>(&step), sizeof(step)) == sizeof(step)
+                 && merges.write(reinterpret_cast<const char*>(&event), sizeof(event)) == sizeof(event);
+            collisionCount++;
+        }
+        statistics.endStep(s + 1, (s + 1) * dt);
+    }
+    merges.close();
+
+    for (int t = 0; t < tiles && ok; ++t) {
+        TileTotals totals;
+        ok = recvValue(sockets[t], totals);
+        if (ok) collisionCount += totals.events;
+    }
+
+    stopTiles();
+
+    if (!ok) {
+        qWarning() << "Falló la comunicación con los mosaicos; corrida abortada.";
+        return false;
+    }
+
+    qDebug() << "Simulación completada.";
+    qDebug() << "Total de colisiones registradas:" << collisionCount;
+    return true;
+}
+
+bool DomainDecomposition::exportToFile(const QString& filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "No se pudo abrir el archivo para escritura:" << filename;
+        return false;
+    }
+
+    QVector<QFile*> trajectoryFiles;
+    QVector<QFile*> eventFiles;
+    bool ok = true;
+    for (int t = 0; t < tiles; ++t) {
+        trajectoryFiles.append(new QFile(trajectoryShard(t)));
+        eventFiles.append(new QFile(eventShard(t)));
+        ok = ok && trajectoryFiles.last()->open(QIODevice::ReadOnly)
+                && eventFiles.last()->open(QIODevice::ReadOnly);
+    }
+    QFile merges(mergeShard());
+    ok = ok && merges.open(QIODevice::ReadOnly);
+
+    QTextStream out(&file);
+
+    // Mismo formato que Simulator::exportToFile
+    out << "# ============================================\n";
+    out << "# Simulación de Sistema de Colisiones Múltiples\n";
+    out << "# ============================================\n";
+    out << "# Dimensiones de la caja: " << SimReal(boxWidth) << " x " << SimReal(boxHeight) << "\n";
+    out << "# Paso de tiempo (dt): " << dt << " segundos\n";
+    // Como Simulator: cuenta también las creadas por fusión
+    out << "# Número de partículas iniciales: "
+        << initialCount + statistics.eventCount(MergeCollision) << "\n";
+    out << "# Número de obstáculos: " << obstacles.size() << "\n";
+    for (int j = 0; j < obstacles.size(); ++j) {
+        QRectF r = obstacles[j].getRect();
+        out << "# Obstáculo " << j << ": " << r.x() << ", " << r.y() << ", "
+            << r.width() << ", " << r.height() << "\n";
+    }
+    out << "# Coeficiente de restitución: "
+        << (obstaclePolicy == Simulator::ElasticObstacles ? SimReal(1) : Simulator::restitutionCoefficient)
+        << "\n";
+    out << "# Precisión numérica: " << simPrecisionName() << "\n";
+    out << "# Mosaicos (procesos): " << tiles << "\n";
+    out << "# ============================================\n\n";
+
+    out << "# TRAYECTORIAS\n";
+    out << "# Formato: Tiempo(s), Partícula_ID, X, Y\n";
+    out << "# ============================================\n";
+
+    // Cada fragmento trae por paso un bloque ordenado por ID: se combinan
+    qint64 totalPoints = 0;
+    QVector<TrajectorySample> stepSamples;
+    QVector<TrajectorySample> block;
+    for (int s = 0; s < steps && ok; ++s) {
+        stepSamples.clear();
+        for (int t = 0; t < tiles && ok; ++t) {
+            qint32 header[2];
+            ok = trajectoryFiles[t]->read(reinterpret_cast<char*>(header), sizeof(header)) == sizeof(header);
+            if (!ok) break;
+            block.resize(header[1]);
+            qint64 bytes = header[1] * qint64(sizeof(TrajectorySample));
+            ok = trajectoryFiles[t]->read(reinterpret_cast<char*>(block.data()), bytes) == bytes;
+            stepSamples += block;
+        }
+        std::sort(stepSamples.begin(), stepSamples.end(),
+                  [](const TrajectorySample& a, const TrajectorySample& b) {
+                      return a.particleId < b.particleId;
+                  });
+        for (const TrajectorySample& sample : stepSamples) {
+            out << sample.step * dt << "," << sample.particleId << ","
+                << sample.x << "," << sample.y << "\n";
+        }
+        totalPoints += stepSamples.size();
+    }
+
+    out << "\n# COLISIONES\n";
+    out << "# Formato: Tiempo(s), Descripción\n";
+    out << "# ============================================\n";
+
+    int kindCounts[3] = { 0, 0, 0 };
+    qint64 totalEvents = 0;
+    QVector<CollisionEvent> stepEvents;
+    QVector<CollisionEvent> eventBlock;
+
+    qint32 nextMergeStep = -1;
+    CollisionEvent nextMerge;
+    if (merges.read(reinterpret_cast<char*>(&nextMergeStep), sizeof(nextMergeStep)) != sizeof(nextMergeStep)
+        || merges.read(reinterpret_cast<char*>(&nextMerge), sizeof(nextMerge)) != sizeof(nextMerge)) {
+        nextMergeStep = -1;
+    }
+
+    for (int s = 0; s < steps && ok; ++s) {
+        stepEvents.clear();
+        for (int t = 0; t < tiles && ok; ++t) {
+            qint32 header[2];
+            ok = eventFiles[t]->read(reinterpret_cast<char*>(header), sizeof(header)) == sizeof(header);
+            if (!ok) break;
+            eventBlock.resize(header[1]);
+            qint64 bytes = header[1] * qint64(sizeof(CollisionEvent));
+            ok = eventFiles[t]->read(reinterpret_cast<char*>(eventBlock.data()), bytes) == bytes;
+            stepEvents += eventBlock;
+        }
+        std::stable_sort(stepEvents.begin(), stepEvents.end(),
+                         [](const CollisionEvent& a, const CollisionEvent& b) {
+                             if (a.kind != b.kind) return a.kind < b.kind;
+                             if (a.particleA != b.particleA) return a.particleA < b.particleA;
+                             return a.other < b.other;
+                         });
+
+        // La fusión del paso (si hubo) va al final, como en el Simulator
+        if (nextMergeStep == s) {
+            stepEvents.append(nextMerge);
+            if (merges.read(reinterpret_cast<char*>(&nextMergeStep), sizeof(nextMergeStep)) != sizeof(nextMergeStep)
+                || merges.read(reinterpret_cast<char*>(&nextMerge), sizeof(nextMerge)) != sizeof(nextMerge)) {
+                nextMergeStep = -1;
+            }
+        }
+
+        for (const CollisionEvent& event : stepEvents) {
+            out << event.time << "," << event.describe() << "\n";
+            kindCounts[event.kind]++;
+        }
+        totalEvents += stepEvents.size();
+    }
+
+    out << "\n# ============================================\n";
+    out << "# RESUMEN\n";
+    out << "# ============================================\n";
+    out << "# Total de puntos de trayectoria registrados: " << totalPoints << "\n";
+    out << "# Total de colisiones registradas: " << totalEvents << "\n";
+    out << "# Colisiones con paredes: " << kindCounts[WallCollision] << "\n";
+    out << "# Colisiones con obstáculos: " << kindCounts[ObstacleCollision] << "\n";
+    out << "# Fusiones de partículas: " << kindCounts[MergeCollision] << "\n";
+    statistics.writeSummary(out);
+    out << "# ============================================\n";
+
+    file.close();
+    qDeleteAll(trajectoryFiles);
+    qDeleteAll(eventFiles);
+
+    if (!ok) {
+        qWarning() << "Fragmentos de mosaico incompletos:" << shardPrefix;
+        return false;
+    }
+
+    qDebug() << "Datos exportados exitosamente a" << filename;
+    return true;
+}
+
+#else
+
+bool DomainDecomposition::startTiles()
+{
+    return false;
+}
+
+void DomainDecomposition::stopTiles()
+{
+}
+
+bool DomainDecomposition::run(double duration, const QString& prefix)
+{
+    Q_UNUSED(duration);
+    Q_UNUSED(prefix);
+    qWarning() << "La descomposición en procesos solo está disponible en Unix.";
+    return false;
+}
+
+bool DomainDecomposition::exportToFile(const QString& filename)
+{
+    Q_UNUSED(filename);
+    return false;
+}
+
+#endif // Q_OS_UNIX
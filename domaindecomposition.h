@@ -0,0 +1,82 @@
+#ifndef DOMAINDECOMPOSITION_H
+#define DOMAINDECOMPOSITION_H
+
+#include "particle.h"
+#include "obstacle.h"
+#include "runstatistics.h"
+#include "simreal.h"
+#include "simulator.h"
+#include <QRectF>
+#include <QString>
+#include <QVector>
+
+// Simulación repartida en procesos por franjas verticales de la caja.
+//
+// Cada franja (mosaico) es un proceso hijo que solo guarda sus partículas.
+// El proceso coordinador reenvía en cada paso, por sockets locales:
+//  - las partículas que migran de franja,
+//  - las partículas fantasma (halo) a menos de 2*radio máximo de un borde,
+//  - la fusión del paso: cada mosaico propone su pareja (i, j) menor entre
+//    pares propio-propio y propio-fantasma, y se aplica la menor global.
+// Los IDs globales coinciden con los índices del Simulator en serie, así que
+// la exportación combinada es la misma que la de una corrida en un proceso.
+// Cada mosaico escribe su fragmento de trayectorias y eventos; exportToFile
+// los combina. Solo Linux/Unix (fork y socketpair).
+class DomainDecomposition
+{
+public:
+    DomainDecomposition(double boxWidth, double boxHeight, double dt, int tiles);
+    ~DomainDecomposition();
+
+    void addParticle(const Particle& particle);
+    void addObstacle(const Obstacle& obstacle);
+
+    // Mismas políticas y núcleos por partícula que Simulator. run() rechaza
+    // PeriodicWalls (las franjas de los extremos no se ven) y los choques
+    // elásticos (la única interacción entre mosaicos es la fusión del paso).
+    void setBoundaryPolicy(Simulator::BoundaryPolicy policy) { boundaryPolicy = policy; }
+    void setPairPolicy(Simulator::PairPolicy policy) { pairPolicy = policy; }
+    void setObstaclePolicy(Simulator::ObstaclePolicy policy) { obstaclePolicy = policy; }
+
+    // shardPrefix: ruta base de los fragmentos de cada mosaico
+    bool run(double duration, const QString& shardPrefix = "simulacion_mosaico");
+
+    // Mismo encabezado y resumen que Simulator::exportToFile, salvo:
+    //  - la línea extra "Mosaicos (procesos)" del encabezado;
+    //  - sin "Pico de memoria": los mosaicos escriben a disco y no hay arena;
+    //  - momento, energía y recorrido se suman por mosaico, en otro orden que
+    //    los bloques del Simulator (pueden diferir en las últimas cifras).
+    bool exportToFile(const QString& filename);
+
+    int tileCount() const { return tiles; }
+    qint64 getCollisionCount() const { return collisionCount; }
+
+private:
+    double boxWidth;
+    double boxHeight;
+    double dt;
+    int tiles;
+    Simulator::BoundaryPolicy boundaryPolicy;
+    Simulator::PairPolicy pairPolicy;
+    Simulator::ObstaclePolicy obstaclePolicy;
+
+    QVector<Particle> initialParticles;   // se liberan al repartirlas
+    QVector<Obstacle> obstacles;
+    int initialCount;
+
+    QString shardPrefix;
+    int steps;
+    qint64 collisionCount;
+    RunStatistics statistics;
+    QVector<qint64> pids;
+    QVector<int> sockets;
+
+    bool startTiles();
+    void stopTiles();
+    void removeShards();
+    QString trajectoryShard(int tile) const;
+    QString eventShard(int tile) const;
+    QString mergeShard() const;
+};
+
+#endif // DOMAINDECOMPOSITION_H
@@ -0,0 +1,135 @@
+#include "frameprofiler.h"
+#include <QFile>
+#include <QTextStream>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+FrameProfiler::FrameProfiler()
+    : enabled(false), tracing(false), expectedNs(16000000), lastTick(-1),
+    current(0), frames(0), dropped(0)
+{
+    std::memset(sections, 0, sizeof(sections));
+    std::memset(interval, 0, sizeof(interval));
+    std::memset(delay, 0, sizeof(delay));
+    scratch.resize(historySize);
+    clock.start();
+}
+
+void FrameProfiler::beginFrame()
+{
+    if (!isActive()) {
+        // Al encender no se mide el hueco desde el último tic registrado
+        lastTick = -1;
+        return;
+    }
+
+    const qint64 tick = now();
+    if (lastTick >= 0) {
+        interval[current] = tick - lastTick;
+        delay[current] = interval[current] - expectedNs;
+        if (tracing) addTraceEvent(SectionCount, lastTick, interval[current]);
+
+        // Se deja libre el espacio del cuadro abierto
+        frames = qMin(frames + 1, historySize - 1);
+        current = (current + 1) % historySize;
+    }
+    for (int s = 0; s < SectionCount; ++s) sections[s][current] = 0;
+    lastTick = tick;
+}
+
+void FrameProfiler::addSample(Section section, qint64 start, qint64 duration)
+{
+    sections[section][current] += duration;
+    if (tracing) addTraceEvent(section, start, duration);
+}
+
+void FrameProfiler::addTraceEvent(qint32 kind, qint64 start, qint64 duration)
+{
+    // Capacidad reservada al empezar: sin memoria nueva durante la traza
+    if (traceEvents.size() >= traceCapacity) {
+        dropped++;
+        return;
+    }
+    TraceEvent event = { kind, start, duration };
+    traceEvents.append(event);
+}
+
+qint64 FrameProfiler::percentile(const qint64* values, double p) const
+{
+    if (frames == 0) return 0;
+
+    for (int i = 0; i < frames; ++i) scratch[i] = values[slot(i)];
+    int k = qBound(0, static_cast<int>(std::ceil(p / 100.0 * frames)) - 1, frames - 1);
+    std::nth_element(scratch.begin(), scratch.begin() + k, scratch.begin() + frames);
+    return scratch[k];
+}
+
+qint64 FrameProfiler::frameTimePercentile(double p) const
+{
+    return percentile(interval, p);
+}
+
+qint64 FrameProfiler::jitterPercentile(double p) const
+{
+    return percentile(delay, p);
+}
+
+qint64 FrameProfiler::sectionPercentile(Section section, double p) const
+{
+    return percentile(sections[section], p);
+}
+
+const char* FrameProfiler::sectionName(Section section)
+{
+    static const char* const names[SectionCount] = { "Física", "Escena", "Pintado" };
+    return names[section];
+}
+
+void FrameProfiler::startTrace()
+{
+    traceEvents.clear();
+    traceEvents.reserve(traceCapacity);
+    dropped = 0;
+    tracing = true;
+}
+
+void FrameProfiler::stopTrace()
+{
+    tracing = false;
+}
+
+bool FrameProfiler::writeTrace(const QString& filename) const
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "No se pudo abrir" << filename;
+        return false;
+    }
+
+    // Formato de eventos de Chrome: secciones y cuadros como eventos
+    // completos ("X") en microsegundos, el retraso del temporizador como
+    // contador ("C")
+    QTextStream out(&file);
+    out.setRealNumberPrecision(3);
+    out.setRealNumberNotation(QTextStream::FixedNotation);
+    out << "{\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"practica5\"}}";
+
+    for (const TraceEvent& event : traceEvents) {
+        double ts = event.start / 1000.0;
+        if (event.kind == SectionCount) {
+            out << ",\n{\"name\":\"Cuadro\",\"cat\":\"cuadro\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+                << ",\"ts\":" << ts << ",\"dur\":" << event.duration / 1000.0 << "}";
+            out << ",\n{\"name\":\"Retraso\",\"ph\":\"C\",\"pid\":1,\"ts\":" << ts
+                << ",\"args\":{\"ms\":" << (event.duration - expectedNs) / 1.0e6 << "}}";
+        } else {
+            out << ",\n{\"name\":\"" << sectionName(static_cast<Section>(event.kind))
+                << "\",\"cat\":\"seccion\",\"ph\":\"X\",\"pid\":1,\"tid\":2"
+                << ",\"ts\":" << ts << ",\"dur\":" << event.duration / 1000.0 << "}";
+        }
+    }
+    out << "\n]}\n";
+    return true;
+}
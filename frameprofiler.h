@@ -0,0 +1,119 @@
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+
+// Perfil de los cuadros del juego. Cada tic del temporizador abre un
+// cuadro (beginFrame); dentro de él se miden secciones con Scope y el
+// intervalo desde el tic anterior da la duración del cuadro y el retraso
+// del temporizador respecto a lo pedido. El pintado de Qt llega después del
+// tic, así que se suma al cuadro abierto.
+//
+// El historial es un anillo fijo de historySize cuadros (sin reservar
+// memoria por cuadro) del que salen el gráfico y los percentiles p50/p99.
+// Con startTrace() además se guardan los eventos con marca de tiempo para
+// escribirlos en el formato de trazas de Chrome (chrome://tracing, Perfetto).
+//
+// Apagado, un Scope cuesta una comparación: no se lee el reloj.
+class FrameProfiler
+{
+public:
+    enum Section {
+        Physics,       // GameEngine::update y los escombros
+        SceneUpdate,   // items de la escena, etiquetas, renderScene
+        Paint,         // pintado de la vista
+        SectionCount
+    };
+
+    static const int historySize = 240;
+    static const int traceCapacity = 1 << 18;
+
+    FrameProfiler();
+
+    void setEnabled(bool on) { enabled = on; }
+    bool isEnabled() const { return enabled; }
+    bool isActive() const { return enabled || tracing; }
+
+    // Intervalo que se le pidió al temporizador, para el retraso
+    void setExpectedInterval(double ms) { expectedNs = static_cast<qint64>(ms * 1.0e6); }
+
+    void beginFrame();
+
+    // El temporizador se detuvo: el próximo tic no cierra cuadro (la pausa
+    // no cuenta como un cuadro largo)
+    void interrupt() { lastTick = -1; }
+
+    // Mide la sección desde su construcción hasta su destrucción
+    class Scope
+    {
+    public:
+        Scope(FrameProfiler& owner, Section section)
+            : profiler(owner.isActive() ? &owner : nullptr), section(section),
+              start(profiler ? owner.now() : 0)
+        {
+        }
+        ~Scope()
+        {
+            if (profiler) profiler->addSample(section, start, profiler->now() - start);
+        }
+
+    private:
+        FrameProfiler* profiler;
+        Section section;
+        qint64 start;
+    };
+
+    // Cuadros cerrados en el historial, del más antiguo (0) al último
+    int frameCount() const { return frames; }
+    qint64 frameTime(int i) const { return interval[slot(i)]; }
+    qint64 jitter(int i) const { return delay[slot(i)]; }     // intervalo - esperado
+    qint64 sample(Section section, int i) const { return sections[section][slot(i)]; }
+
+    // Percentil p (0-100) en nanosegundos sobre el historial
+    qint64 frameTimePercentile(double p) const;
+    qint64 jitterPercentile(double p) const;
+    qint64 sectionPercentile(Section section, double p) const;
+
+    static const char* sectionName(Section section);
+
+    // Traza para chrome://tracing o Perfetto
+    void startTrace();
+    void stopTrace();
+    bool isTracing() const { return tracing; }
+    int traceEventCount() const { return traceEvents.size(); }
+    int droppedTraceEvents() const { return dropped; }
+    bool writeTrace(const QString& filename) const;
+
+private:
+    struct TraceEvent {
+        qint32 kind;       // Section, o SectionCount para el cuadro
+        qint64 start;
+        qint64 duration;   // en el cuadro, el intervalo desde el tic anterior
+    };
+
+    bool enabled;
+    bool tracing;
+    QElapsedTimer clock;
+    qint64 expectedNs;
+    qint64 lastTick;
+
+    qint64 sections[SectionCount][historySize];
+    qint64 interval[historySize];
+    qint64 delay[historySize];
+    int current;              // cuadro abierto (no cuenta en el historial)
+    int frames;
+
+    QVector<TraceEvent> traceEvents;
+    int dropped;
+    mutable QVector<qint64> scratch;   // copia para los percentiles
+
+    qint64 now() const { return clock.nsecsElapsed(); }
+    int slot(int i) const { return (current - frames + i + historySize) % historySize; }
+    void addSample(Section section, qint64 start, qint64 duration);
+    void addTraceEvent(qint32 kind, qint64 start, qint64 duration);
+    qint64 percentile(const qint64* values, double p) const;
+};
+
+#endif // FRAMEPROFILER_H
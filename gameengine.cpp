@@ -1,19 +1,128 @@
 #include "gameengine.h"
 #include <cmath>
+#include <limits>
+#include <algorithm>
 #include <QDebug>
 
+namespace {
+
+// Tramo balístico en forma cerrada desde el último rebote. update(dt)
+// avanza la posición antes de aplicar la gravedad, así que tras k pasos
+// (t = k dt) x = x0 + vx t,  y = y0 + (vy - g dt / 2) t + (g / 2) t²:
+// la parábola pasa exactamente por las posiciones que calcula el motor.
+struct BallisticSegment {
+    double x0, y0;
+    double vx, vy;   // velocidad del motor al inicio del tramo
+    double ay;       // g / 2 (> 0)
+    double by;       // vy - g dt / 2
+
+    double x(double t) const { return x0 + vx * t; }
+    double y(double t) const { return y0 + (by + ay * t) * t; }
+    QPointF velocityAt(double t) const { return QPointF(vx, vy + 2 * ay * t); }
+};
+
+const double never = std::numeric_limits<double>::infinity();
+
+// Holguras de la búsqueda de eventos. Las posiciones en forma cerrada y las
+// que acumula update() difieren en el redondeo; con estas holguras la
+// búsqueda nunca se pasa del paso real del evento (a lo más se detiene un
+// paso antes, y en ese paso no ocurre nada).
+const double frameSlack = 1e-6;     // en fracciones de paso
+const double contactSlack = 1e-6;   // en unidades de distancia
+
+// Instantes en que y(t) == level, en orden ascendente
+bool levelCrossings(const BallisticSegment& s, double level, double& t0, double& t1)
+{
+    double disc = s.by * s.by - 4 * s.ay * (s.y0 - level);
+    if (disc < 0) return false;
+    double root = std::sqrt(disc);
+    t0 = (-s.by - root) / (2 * s.ay);
+    t1 = (-s.by + root) / (2 * s.ay);
+    return true;
+}
+
+// Primer paso k >= 1 (como tiempo k dt) dentro de [from, to]
+double firstFrameIn(double from, double to, double dt)
+{
+    double t = std::max(1.0, std::ceil(from / dt - frameSlack)) * dt;
+    return t <= to + frameSlack * dt ? t : never;
+}
+
+// Primer paso antes de tMax en que el círculo toca el rectángulo, con la
+// misma prueba que circleHitsRect. Los intervalos posibles salen en forma
+// cerrada sobre el rectángulo ampliado por el radio: la franja en x es
+// lineal y la franja en y queda entre las raíces de dos parábolas. Solo en
+// las esquinas, donde el contorno real es redondeado, se revisa paso a paso.
+double firstContactFrame(const BallisticSegment& s, const QRectF& rect, double radius,
+                         double dt, double tMax)
+{
+    double left = rect.left() - radius;
+    double right = rect.right() + radius;
+    double top = rect.top() - radius;
+    double bottom = rect.bottom() + radius;
+
+    double xa = -never, xb = never;
+    if (s.vx != 0) {
+        xa = (left - s.x0) / s.vx;
+        xb = (right - s.x0) / s.vx;
+        if (xa > xb) std::swap(xa, xb);
+    } else if (s.x0 < left || s.x0 > right) {
+        return never;
+    }
+
+    // y <= bottom entre sus cruces; y >= top fuera de los suyos
+    double b0, b1;
+    if (!levelCrossings(s, bottom, b0, b1)) return never;
+
+    double spans[2][2];
+    int spanCount = 0;
+    double t0, t1;
+    if (levelCrossings(s, top, t0, t1)) {
+        spans[spanCount][0] = b0; spans[spanCount][1] = t0; spanCount++;
+        spans[spanCount][0] = t1; spans[spanCount][1] = b1; spanCount++;
+    } else {
+        spans[spanCount][0] = b0; spans[spanCount][1] = b1; spanCount++;
+    }
+
+    for (int k = 0; k < spanCount; ++k) {
+        double enter = std::max(spans[k][0], xa);
+        double leave = std::min(std::min(spans[k][1], xb), tMax);
+
+        double t = firstFrameIn(enter, leave, dt);
+        for (qint64 step = qint64(t / dt + 0.5); t <= leave; t = ++step * dt) {
+            if (circleHitsRect(s.x(t), s.y(t), radius,
+                               rect.left(), rect.top(), rect.right(), rect.bottom())) {
+                return t;
+            }
+        }
+    }
+    return never;
+}
+
+} // namespace
+
 GameEngine::GameEngine(double w, double h)
     : boxWidth(w), boxHeight(h), currentPlayer(1),
-    gameOver(false), winner(0), activeProjectile(nullptr)
+    gameOver(false), winner(0), revision(0), activeProjectile(nullptr),
+    player1Grid(w, h), player2Grid(w, h), player1Alive(0), player2Alive(0),
+    debris(w, h), debrisEnabled(true), standingDirty(true)
 {
 }
 
 void GameEngine::addInfrastructure(int player, const Infrastructure& infra)
 {
-    if (player == 1) {
-        player1Infrastructure.append(infra);
-    } else {
-        player2Infrastructure.append(infra);
+    QVector<Infrastructure>& list = (player == 1) ? player1Infrastructure : player2Infrastructure;
+    InfrastructureGrid& grid = (player == 1) ? player1Grid : player2Grid;
+    int& alive = (player == 1) ? player1Alive : player2Alive;
+
+    list.append(infra);
+    revision++;
+
+    // Solo las estructuras en pie entran al índice y al contador
+    if (!infra.isDestroyed()) {
+        grid.insert(list.size() - 1, infra.getRect());
+        alive++;
+        standingDirty = true;
     }
 }
 
@@ -49,14 +158,257 @@ bool GameEngine::update(double dt)
     return true;
 }
 
-void GameEngine::handleWallCollisions()
+void GameEngine::predictTrajectory(int player, double angle, double speed, double frameDt,
+                                   TrajectoryPreview& out) const
 {
-    if (!activeProjectile || !activeProjectile->isActive()) return;
+    out.path.clear();
+    out.bounces.clear();
+    out.blocksHit = 0;
+    out.blocksDestroyed = 0;
+    if (frameDt <= 0) return;
 
-    QPointF pos = activeProjectile->getPosition();
-    QPointF vel = activeProjectile->getVelocity();
-    double radius = activeProjectile->getRadius();
+    QVector<ShotHit> hits;
+    traceShot(player, angle, speed, frameDt, maxPreviewTime, maxPreviewBounces, hits, &out);
+}
+
+double GameEngine::playShot(double angle, double speed, double frameDt)
+{
+    if (gameOver || activeProjectile != nullptr || frameDt <= 0) return 0.0;
+
+    traceShot(currentPlayer, angle, speed, frameDt, maxShotTime,
+              std::numeric_limits<int>::max(), shotHits, nullptr);
+
+    QVector<Infrastructure>& targetInfra =
+        (currentPlayer == 1) ? player2Infrastructure : player1Infrastructure;
+
+    // Golpes en el mismo orden que los daría update()
+    double dealt = 0.0;
+    for (const ShotHit& hit : shotHits) {
+        Infrastructure& block = targetInfra[hit.block];
+        dealt += qMin(hit.damage, block.getResistance());
+        if (block.takeDamage(hit.damage)) {
+            destroyBlock(currentPlayer == 1 ? 2 : 1, hit.block, hit.velocity);
+        }
+        revision++;
+    }
+
+    checkVictoryConditions();
+    switchTurn();
+    return dealt;
+}
+
+void GameEngine::traceShot(int player, double angle, double speed, double frameDt,
+                           double timeLimit, int bounceLimit,
+                           QVector<ShotHit>& hits, TrajectoryPreview* out) const
+{
+    // Mismo arranque que launchProjectile
+    double startX = (player == 1) ? 50 : boxWidth - 50;
+    double startY = boxHeight - 50;
+    Projectile probe(startX, startY, angle, speed, projectileMass);
+
+    const double radius = probe.getRadius();
+    const double g = probe.getGravity();
 
+    const QVector<Infrastructure>& targetInfra =
+        (player == 1) ? player2Infrastructure : player1Infrastructure;
+    const InfrastructureGrid& targetGrid = (player == 1) ? player2Grid : player1Grid;
+    const double chunkLength = 0.5 * targetGrid.getCellSize();
+    const double reach = radius + contactSlack;
+
+    // Resistencia de cada bloque en la simulación en seco, restada golpe
+    // por golpe como en Infrastructure::takeDamage
+    hits.clear();
+    QVector<double> remaining(targetInfra.size());
+    for (int i = 0; i < targetInfra.size(); ++i) {
+        remaining[i] = targetInfra[i].getResistance();
+    }
+    auto standing = [&](int i) { return remaining[i] > 0; };
+    QVector<int> nearby;
+    QVector<int> liveNearby;
+    RectPack<double> liveRects;
+
+    QPointF pos(startX, startY);
+    QPointF vel = probe.getVelocity();
+    if (out) out->path.append(pos);
+
+    const qint64 frameLimit = static_cast<qint64>(timeLimit / frameDt);
+    qint64 frame = 0;
+    int bounces = 0;
+    while (frame < frameLimit) {
+        BallisticSegment seg = { pos.x(), pos.y(), vel.x(), vel.y(),
+                                 0.5 * g, vel.y() - 0.5 * g * frameDt };
+
+        // Próximo paso con algo que resolver: salida por el fondo, paredes,
+        // techo o contacto con un bloque
+        double tEvent = (frameLimit - frame) * frameDt;
+        double above, below;
+        if (levelCrossings(seg, boxHeight, above, below)) {
+            tEvent = qMin(tEvent, firstFrameIn(below, never, frameDt));
+        }
+        if (seg.vx < 0) {
+            tEvent = qMin(tEvent, firstFrameIn((radius - seg.x0) / seg.vx, never, frameDt));
+        } else if (seg.vx > 0) {
+            tEvent = qMin(tEvent, firstFrameIn((boxWidth - radius - seg.x0) / seg.vx, never, frameDt));
+        }
+        if (levelCrossings(seg, radius, above, below)) {
+            tEvent = qMin(tEvent, firstFrameIn(above, below, frameDt));
+        }
+
+        // Los bloques se buscan por trozos de recorrido que crecen desde el
+        // radio hasta media celda (tras un rebote el siguiente contacto suele
+        // estar muy cerca), consultando el índice con la caja del arco
+        // ampliada por el radio; un contacto dentro del trozo termina la búsqueda
+        double t0 = 0.0;
+        double length = radius;
+        while (t0 < tEvent) {
+            QPointF v0 = seg.velocityAt(t0);
+            double vy0 = v0.y() - 0.5 * g * frameDt;
+            double step = length / qMax(1.0, std::sqrt(v0.x() * v0.x() + vy0 * vy0));
+            length = qMin(2 * length, chunkLength);
+            double t1 = qMin(t0 + step, tEvent);
+
+            double xLow = qMin(seg.x(t0), seg.x(t1));
+            double xHigh = qMax(seg.x(t0), seg.x(t1));
+            double yLow = qMin(seg.y(t0), seg.y(t1));
+            double yHigh = qMax(seg.y(t0), seg.y(t1));
+            double apex = -seg.by / (2 * seg.ay);
+            if (apex > t0 && apex < t1) yLow = qMin(yLow, seg.y(apex));
+
+            QRectF area(xLow - reach, yLow - reach,
+                        xHigh - xLow + 2 * reach, yHigh - yLow + 2 * reach);
+            targetGrid.query(area, nearby);
+
+            for (int k = 0; k < nearby.size(); ++k) {
+                int i = nearby[k];
+                // Las celdas cubren más que el trozo: descarte rápido por caja
+                QRectF rect = targetInfra[i].getRect();
+                if (!rect.intersects(area) || !standing(i)) continue;
+                tEvent = qMin(tEvent, firstContactFrame(seg, rect, reach, frameDt, tEvent));
+            }
+
+            if (tEvent <= t1) break;
+            t0 = t1;
+        }
+
+        // Muestras del tramo a ~previewSpacing de distancia
+        if (out) {
+            QPointF vEnd = seg.velocityAt(tEvent);
+            double meanSpeed = 0.5 * (std::sqrt(vel.x() * vel.x() + vel.y() * vel.y())
+                                      + std::sqrt(vEnd.x() * vEnd.x() + vEnd.y() * vEnd.y()));
+            int samples = qBound(1, static_cast<int>(std::ceil(meanSpeed * tEvent / previewSpacing)), 512);
+            for (int k = 1; k < samples; ++k) {
+                double t = tEvent * k / samples;
+                out->path.append(QPointF(seg.x(t), seg.y(t)));
+            }
+        }
+
+        // El estado en el paso del evento se repite con las mismas
+        // operaciones que Projectile::update (unas pocas sumas por paso), así
+        // coincide bit a bit con el del motor y las pruebas de contacto de
+        // abajo deciden igual que update()
+        qint64 steps = qMax<qint64>(1, std::llround(tEvent / frameDt));
+        double px = pos.x(), py = pos.y(), vx = vel.x(), vy = vel.y();
+        for (qint64 k = 0; k < steps; ++k) {
+            px = px + vx * frameDt;
+            py = py + vy * frameDt;
+            vy = vy + g * frameDt;
+        }
+        frame += steps;
+        pos = QPointF(px, py);
+        vel = QPointF(vx, vy);
+
+        // En el paso del evento se aplican las mismas reglas que update():
+        // paredes, luego bloques, luego la salida por el fondo. Los
+        // candidatos del último trozo ya cubren esta posición, salvo que la
+        // pared la haya corrido.
+        bool bounced = bounceOffWalls(pos, vel, radius);
+        if (bounced) targetGrid.query(pos, radius, nearby);
+
+        liveNearby.clear();
+        liveRects.clear();
+        for (int k = 0; k < nearby.size(); ++k) {
+            if (standing(nearby[k])) {
+                liveNearby.append(nearby[k]);
+                liveRects.append(targetInfra[nearby[k]].getRect());
+            }
+        }
+
+        int side = 0;
+        int hit = firstCircleRectHit(pos.x(), pos.y(), radius, liveRects, &side);
+        if (hit >= 0) {
+            int i = liveNearby[hit];
+            double damage = damageFactor * projectileMass
+                            * std::sqrt(vel.x() * vel.x() + vel.y() * vel.y());
+            ShotHit record = { i, damage, vel };
+            hits.append(record);
+            remaining[i] = qMax(0.0, remaining[i] - damage);
+            if (out) {
+                out->blocksHit++;
+                if (!standing(i)) out->blocksDestroyed++;
+            }
+
+            if (side == 0 || side == 2) {
+                vel.setY(-vel.y() * restitutionCoefficient);
+            } else {
+                vel.setX(-vel.x() * restitutionCoefficient);
+            }
+            bounced = true;
+        }
+
+        if (out) out->path.append(pos);
+        if (pos.y() > boxHeight) break;
+        if (bounced) {
+            if (out) out->bounces.append(pos);
+            if (++bounces > bounceLimit) break;
+        }
+    }
+}
+
+bool GameEngine::updateDebris(double dt)
+{
+    if (!debrisEnabled) return false;
+
+    // Los escombros chocan con los bloques en pie de ambos jugadores
+    if (standingDirty) {
+        QVector<QRectF> standing;
+        for (const Infrastructure& infra : player1Infrastructure) {
+            if (!infra.isDestroyed()) standing.append(infra.getRect());
+        }
+        for (const Infrastructure& infra : player2Infrastructure) {
+            if (!infra.isDestroyed()) standing.append(infra.getRect());
+        }
+        debris.setBlocks(standing);
+        standingDirty = false;
+    }
+    return debris.update(dt);
+}
+
+void GameEngine::setDebrisEnabled(bool enabled)
+{
+    debrisEnabled = enabled;
+    if (!enabled) debris.clear();
+}
+
+void GameEngine::destroyBlock(int player, int index, const QPointF& velocity)
+{
+    const Infrastructure& block =
+        (player == 1) ? player1Infrastructure[index] : player2Infrastructure[index];
+    InfrastructureGrid& grid = (player == 1) ? player1Grid : player2Grid;
+    int& alive = (player == 1) ? player1Alive : player2Alive;
+
+    grid.remove(index, block.getRect());
+    alive--;
+    standingDirty = true;
+
+    if (debrisEnabled) {
+        // Lo que estaba apoyado en el bloque vuelve a caer
+        debris.shatter(block.getRect(), velocity, static_cast<quint8>(player));
+        debris.wake(block.getRect());
+    }
+}
+
+bool GameEngine::bounceOffWalls(QPointF& pos, QPointF& vel, double radius) const
+{
     bool collided = false;
 
     if (pos.x() - radius <= 0) {
@@ -75,7 +427,18 @@ void GameEngine::handleWallCollisions()
         collided = true;
     }
 
-    if (collided) {
+    return collided;
+}
+
+void GameEngine::handleWallCollisions()
+{
+    if (!activeProjectile || !activeProjectile->isActive()) return;
+
+    QPointF pos = activeProjectile->getPosition();
+    QPointF vel = activeProjectile->getVelocity();
+    double radius = activeProjectile->getRadius();
+
+    if (bounceOffWalls(pos, vel, radius)) {
         activeProjectile->setVelocity(vel);
         activeProjectile->setPosition(pos);
     }
@@ -91,52 +454,50 @@ void GameEngine::handleInfrastructureCollisions()
 
     QVector<Infrastructure>* targetInfra =
         (currentPlayer == 1) ? &player2Infrastructure : &player1Infrastructure;
+    InfrastructureGrid& targetGrid = (currentPlayer == 1) ? player2Grid : player1Grid;
 
-    for (int i = 0; i < targetInfra->size(); ++i) {
-        if ((*targetInfra)[i].checkCollision(pos, radius)) {
-            QPointF prevPos = pos - vel * 0.01;
-            int side = (*targetInfra)[i].getCollisionSide(pos, prevPos);
+    // Solo se prueban los bloques que comparten celda con el proyectil
+    targetGrid.query(pos, radius, candidates);
 
-            double speed = std::sqrt(vel.x() * vel.x() + vel.y() * vel.y());
-            double damage = damageFactor * projectileMass * speed;
+    // Empaquetar los candidatos y probarlos por lotes
+    candidateRects.clear();
+    for (int k = 0; k < candidates.size(); ++k) {
+        candidateRects.append((*targetInfra)[candidates[k]].getRect());
+    }
 
-            (*targetInfra)[i].takeDamage(damage);
+    int side = 0;
+    int hit = firstCircleRectHit(pos.x(), pos.y(), radius, candidateRects, &side);
+    if (hit < 0) return;
 
-            qDebug() << "Colisión! Daño:" << damage
-                     << "Resistencia restante:" << (*targetInfra)[i].getResistance();
+    int i = candidates[hit];
 
-            if (side == 0 || side == 2) {
-                vel.setY(-vel.y() * restitutionCoefficient);
-            } else {
-                vel.setX(-vel.x() * restitutionCoefficient);
-            }
+    double speed = std::sqrt(vel.x() * vel.x() + vel.y() * vel.y());
+    double damage = damageFactor * projectileMass * speed;
+
+    revision++;
+    if ((*targetInfra)[i].takeDamage(damage)) {
+        destroyBlock(currentPlayer == 1 ? 2 : 1, i, vel);
+    }
 
-            activeProjectile->setVelocity(vel);
+    qDebug() << "Colisión! Daño:" << damage
+             << "Resistencia restante:" << (*targetInfra)[i].getResistance();
 
-            checkVictoryConditions();
-            break;
-        }
+    if (side == 0 || side == 2) {
+        vel.setY(-vel.y() * restitutionCoefficient);
+    } else {
+        vel.setX(-vel.x() * restitutionCoefficient);
     }
+
+    activeProjectile->setVelocity(vel);
+
+    checkVictoryConditions();
 }
 
 void GameEngine::checkVictoryConditions()
 {
-    bool player1Defeated = true;
-    bool player2Defeated = true;
-
-    for (const Infrastructure& infra : player1Infrastructure) {
-        if (!infra.isDestroyed()) {
-            player1Defeated = false;
-            break;
-        }
-    }
-
-    for (const Infrastructure& infra : player2Infrastructure) {
-        if (!infra.isDestroyed()) {
-            player2Defeated = false;
-            break;
-        }
-    }
+    // Los contadores se actualizan en cada destrucción: O(1)
+    bool player1Defeated = (player1Alive == 0);
+    bool player2Defeated = (player2Alive == 0);
 
     if (player1Defeated) {
         gameOver = true;
@@ -150,5 +511,6 @@ void GameEngine::checkVictoryConditions()
 void GameEngine::switchTurn()
 {
     currentPlayer = (currentPlayer == 1) ? 2 : 1;
+    revision++;
     checkVictoryConditions();
 }
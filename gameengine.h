@@ -3,9 +3,20 @@
 
 #include "projectile.h"
 #include "infranstructure.h"
+#include "infrastructuregrid.h"
+#include "collisionkernels.h"
+#include "debrissystem.h"
 #include <QVector>
 #include <QString>
 
+// Trayectoria prevista de un disparo (ver GameEngine::predictTrajectory)
+struct TrajectoryPreview {
+    QVector<QPointF> path;      // polilínea para dibujar
+    QVector<QPointF> bounces;   // rebotes en paredes, techo y bloques
+    int blocksHit;
+    int blocksDestroyed;
+};
+
 class GameEngine
 {
 public:
@@ -16,6 +27,42 @@ public:
 
     bool update(double dt);
 
+    // Simulación en seco de un disparo lanzado ahora y avanzado con
+    // update(frameDt), sin modificar el juego. Entre rebotes la trayectoria
+    // es una parábola en forma cerrada: el paso del próximo evento (pared,
+    // techo, bloque del rival o salida por el fondo) se calcula directo, sin
+    // recorrer los pasos intermedios, y en ese paso se aplican las mismas
+    // reglas que update(), con el daño acumulado de los golpes previos.
+    void predictTrajectory(int player, double angle, double speed, double frameDt,
+                           TrajectoryPreview& out) const;
+
+    // Resuelve el disparo completo del jugador en turno sin pasar por
+    // update(): aplica el daño del trazado de predictTrajectory y cambia el
+    // turno, con el mismo resultado que lanzar y llamar update(frameDt)
+    // hasta que el proyectil salga. Retorna la resistencia efectivamente
+    // quitada. Pensado para corridas sin interfaz (ver tournament.h).
+    double playShot(double angle, double speed, double frameDt);
+
+    // Escombros de los bloques destruidos (ver debrissystem.h). Avanzan
+    // aparte del proyectil, así que pueden seguir cayendo después del
+    // disparo; retorna true mientras quede alguno en movimiento. No afectan
+    // al juego: sin escombros (p. ej. en los torneos) el resultado es el mismo.
+    bool updateDebris(double dt);
+    void setDebrisEnabled(bool enabled);
+    void setGroundLevel(double y) { debris.setGround(y); }
+    bool isDebrisEnabled() const { return debrisEnabled; }
+    const DebrisSystem& getDebris() const { return debris; }
+
+    // Parámetros de balance (por defecto los del juego original)
+    void setDamageFactor(double factor) { damageFactor = factor; }
+    void setRestitutionCoefficient(double coefficient) { restitutionCoefficient = coefficient; }
+    double getDamageFactor() const { return damageFactor; }
+    double getRestitutionCoefficient() const { return restitutionCoefficient; }
+
+    // Cambia con cada daño, estructura nueva o cambio de turno: una
+    // trayectoria prevista sigue siendo válida mientras no cambie
+    int getRevision() const { return revision; }
+
     int getCurrentPlayer() const { return currentPlayer; }
     bool isGameOver() const { return gameOver; }
     int getWinner() const { return winner; }
@@ -29,15 +76,55 @@ private:
     int currentPlayer;
     bool gameOver;
     int winner;
+    int revision;
 
     QVector<Infrastructure> player1Infrastructure;
     QVector<Infrastructure> player2Infrastructure;
     Projectile* activeProjectile;
 
-    const double restitutionCoefficient = 0.6;
-    const double damageFactor = 0.5;
+    // Índices espaciales y contadores de estructuras en pie por jugador
+    InfrastructureGrid player1Grid;
+    InfrastructureGrid player2Grid;
+    int player1Alive;
+    int player2Alive;
+    QVector<int> candidates;  // buffer reutilizado por las consultas
+    RectPack<double> candidateRects;  // rectángulos de los candidatos, empaquetados
+
+    DebrisSystem debris;
+    bool debrisEnabled;
+    bool standingDirty;       // los bloques de los escombros están desactualizados
+
+    double restitutionCoefficient = 0.6;
+    double damageFactor = 0.5;
     const double projectileMass = 1.0;
 
+    // Límites de la simulación en seco (un bloque pegado puede rebotar en
+    // cada paso, como en update)
+    const int maxPreviewBounces = 1000;
+    const double maxPreviewTime = 60.0;
+    const double maxShotTime = 600.0;    // playShot (update no tiene límite)
+    const double previewSpacing = 8.0;   // distancia aproximada entre puntos
+
+    // Golpe a un bloque del rival durante un trazado
+    struct ShotHit {
+        int block;
+        double damage;
+        QPointF velocity;   // del proyectil al golpear, para los escombros
+    };
+    QVector<ShotHit> shotHits;   // golpes del último playShot
+
+    // Rebote contra paredes y techo (lo comparten update y la previsión)
+    bool bounceOffWalls(QPointF& pos, QPointF& vel, double radius) const;
+
+    // Trazado por eventos de predictTrajectory y playShot: deja los golpes
+    // en orden en hits y, si out no es nulo, la polilínea
+    void traceShot(int player, double angle, double speed, double frameDt,
+                   double timeLimit, int bounceLimit,
+                   QVector<ShotHit>& hits, TrajectoryPreview* out) const;
+
+    // Quita el bloque del índice y lo rompe en escombros
+    void destroyBlock(int player, int index, const QPointF& velocity);
+
     void handleWallCollisions();
     void handleInfrastructureCollisions();
     void checkVictoryConditions();
@@ -2,7 +2,6 @@
 #define INFRASTRUCTURE_H
 
 #include <QRectF>
-#include <QGraphicsRectItem>
 
 class Infrastructure
 {
@@ -13,7 +12,8 @@ public:
     double getResistance() const { return resistance; }
     bool isDestroyed() const { return resistance <= 0; }
 
-    void takeDamage(double damage);
+    // Retorna true si este impacto dejó la estructura destruida
+    bool takeDamage(double damage);
 
     bool checkCollision(const QPointF& center, double radius) const;
     int getCollisionSide(const QPointF& center, const QPointF& prevCenter) const;
@@ -0,0 +1,96 @@
+#include "infrastructuregrid.h"
+#include <cmath>
+#include <algorithm>
+
+InfrastructureGrid::InfrastructureGrid(double w, double h, double cs)
+    : width(w), height(h), cellSize(cs), liveEntries(0), currentStamp(0)
+{
+    cols = std::max(1, static_cast<int>(std::ceil(width / cellSize)));
+    rows = std::max(1, static_cast<int>(std::ceil(height / cellSize)));
+    cells.resize(cols * rows);
+}
+
+void InfrastructureGrid::cellRange(double left, double top, double right, double bottom,
+                                   int& c0, int& r0, int& c1, int& r1) const
+{
+    // Los rectángulos fuera de la caja se sujetan a las celdas del borde
+    c0 = std::max(0, std::min(cols - 1, static_cast<int>(std::floor(left / cellSize))));
+    r0 = std::max(0, std::min(rows - 1, static_cast<int>(std::floor(top / cellSize))));
+    c1 = std::max(0, std::min(cols - 1, static_cast<int>(std::floor(right / cellSize))));
+    r1 = std::max(0, std::min(rows - 1, static_cast<int>(std::floor(bottom / cellSize))));
+}
+
+void InfrastructureGrid::insert(int index, const QRectF& rect)
+{
+    int c0, r0, c1, r1;
+    cellRange(rect.left(), rect.top(), rect.right(), rect.bottom(), c0, r0, c1, r1);
+
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) {
+            cells[r * cols + c].append(index);
+        }
+    }
+
+    if (index >= stamps.size()) {
+        stamps.resize(index + 1);
+    }
+    liveEntries++;
+}
+
+void InfrastructureGrid::remove(int index, const QRectF& rect)
+{
+    int c0, r0, c1, r1;
+    cellRange(rect.left(), rect.top(), rect.right(), rect.bottom(), c0, r0, c1, r1);
+
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) {
+            QVector<int>& cell = cells[r * cols + c];
+            for (int k = 0; k < cell.size(); ++k) {
+                if (cell[k] == index) {
+                    // Quitar intercambiando con el último (el orden se
+                    // recupera al ordenar los resultados de la consulta)
+                    cell[k] = cell.last();
+                    cell.removeLast();
+                    break;
+                }
+            }
+        }
+    }
+
+    liveEntries--;
+}
+
+void InfrastructureGrid::query(const QPointF& center, double radius, QVector<int>& out) const
+{
+    query(QRectF(center.x() - radius, center.y() - radius, 2 * radius, 2 * radius), out);
+}
+
+void InfrastructureGrid::query(const QRectF& area, QVector<int>& out) const
+{
+    out.clear();
+
+    int c0, r0, c1, r1;
+    cellRange(area.left(), area.top(), area.right(), area.bottom(), c0, r0, c1, r1);
+
+    if (++currentStamp == 0) {
+        // Desbordamiento del contador: reiniciar las marcas
+        std::fill(stamps.begin(), stamps.end(), 0u);
+        currentStamp = 1;
+    }
+
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) {
+            const QVector<int>& cell = cells[r * cols + c];
+            for (int k = 0; k < cell.size(); ++k) {
+                int index = cell[k];
+                if (stamps[index] != currentStamp) {
+                    stamps[index] = currentStamp;
+                    out.append(index);
+                }
+            }
+        }
+    }
+
+    // Mantener el mismo orden de prioridad que el recorrido lineal
+    std::sort(out.begin(), out.end());
+}
@@ -0,0 +1,48 @@
+#ifndef INFRASTRUCTUREGRID_H
+#define INFRASTRUCTUREGRID_H
+
+#include <QRectF>
+#include <QPointF>
+#include <QVector>
+
+// Índice espacial uniforme sobre los rectángulos de infraestructura de un
+// jugador. Cada celda guarda los índices (posiciones en el QVector del
+// jugador) de los bloques que la tocan; los bloques destruidos se retiran
+// para que las consultas no vuelvan a recorrerlos.
+class InfrastructureGrid
+{
+public:
+    InfrastructureGrid(double width, double height, double cellSize = 64.0);
+
+    void insert(int index, const QRectF& rect);
+    void remove(int index, const QRectF& rect);
+
+    // Índices candidatos cuyo rectángulo comparte celda con el AABB del
+    // círculo, sin duplicados y en orden ascendente
+    void query(const QPointF& center, double radius, QVector<int>& out) const;
+
+    // Igual, para un área rectangular cualquiera
+    void query(const QRectF& area, QVector<int>& out) const;
+
+    int size() const { return liveEntries; }
+    double getCellSize() const { return cellSize; }
+
+private:
+    double width;
+    double height;
+    double cellSize;
+    int cols;
+    int rows;
+    int liveEntries;
+
+    QVector<QVector<int>> cells;      // cells[row * cols + col] -> índices
+
+    // Marcas para no repetir un bloque que ocupa varias celdas
+    mutable QVector<unsigned int> stamps;
+    mutable unsigned int currentStamp;
+
+    void cellRange(double left, double top, double right, double bottom,
+                   int& c0, int& r0, int& c1, int& r1) const;
+};
+
+#endif // INFRASTRUCTUREGRID_H
@@ -0,0 +1,204 @@
+#include "initialconditions.h"
+#include <QDebug>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const quint32 conditionsMagic = 0x50354943;   // 'P5IC'
+const quint32 conditionsVersion = 1;
+
+quint64 align64(quint64 bytes)
+{
+    return (bytes + 63) & ~quint64(63);
+}
+
+template <typename From>
+void convertColumn(const uchar* data, int count, SimReal* out)
+{
+    const From* in = reinterpret_cast<const From*>(data);
+    for (int i = 0; i < count; ++i) {
+        out[i] = static_cast<SimReal>(in[i]);
+    }
+}
+
+bool writePadding(QFile& file, quint64 bytes)
+{
+    static const char zeros[64] = {};
+    return bytes == 0 || file.write(zeros, static_cast<qint64>(bytes)) == static_cast<qint64>(bytes);
+}
+
+} // namespace
+
+InitialConditionsFile::InitialConditionsFile()
+    : base(nullptr), header(nullptr)
+{
+}
+
+InitialConditionsFile::~InitialConditionsFile()
+{
+    close();
+}
+
+bool InitialConditionsFile::open(const QString& filename)
+{
+    close();
+
+    file.setFileName(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "No se pudo abrir el archivo:" << filename;
+        return false;
+    }
+
+    qint64 bytes = file.size();
+    if (bytes < static_cast<qint64>(sizeof(InitialConditionsHeader))) {
+        qWarning() << "Archivo de condiciones iniciales truncado:" << filename;
+        file.close();
+        return false;
+    }
+
+    base = file.map(0, bytes);
+    if (!base) {
+        qWarning() << "No se pudo mapear el archivo:" << filename << file.errorString();
+        file.close();
+        return false;
+    }
+
+    const InitialConditionsHeader* h = reinterpret_cast<const InitialConditionsHeader*>(base);
+    const quint64 size = quint64(bytes);
+    const quint64 firstColumn = align64(sizeof(InitialConditionsHeader));
+    quint64 count = h->particleCount;
+
+    // Las columnas se leen directo del mapeo: cada sección debe caber en el
+    // archivo. Los límites se comparan por división, sin productos ni sumas
+    // que puedan desbordar con un encabezado editado, y el paso entre
+    // columnas debe conservar la alineación del tipo real
+    bool valid = h->magic == conditionsMagic && h->version == conditionsVersion
+                 && (h->realSize == sizeof(float) || h->realSize == sizeof(double))
+                 && count <= quint64(std::numeric_limits<int>::max())
+                 && h->obstacleCount <= quint64(std::numeric_limits<int>::max())
+                 && h->fileBytes == size
+                 && firstColumn <= size
+                 && h->columnStride % h->realSize == 0
+                 && h->columnStride >= count * h->realSize
+                 && h->columnStride <= (size - firstColumn) / 6
+                 && h->activeOffset >= firstColumn + 6 * h->columnStride
+                 && h->activeOffset <= size
+                 && count <= size - h->activeOffset
+                 && h->obstaclesOffset >= h->activeOffset + count
+                 && h->obstaclesOffset <= size
+                 && h->obstacleCount <= (size - h->obstaclesOffset) / (4 * sizeof(double));
+    if (!valid) {
+        qWarning() << "Archivo de condiciones iniciales inválido:" << filename;
+        file.unmap(const_cast<uchar*>(base));
+        file.close();
+        base = nullptr;
+        return false;
+    }
+
+    header = h;
+    return true;
+}
+
+void InitialConditionsFile::close()
+{
+    if (base) {
+        file.unmap(const_cast<uchar*>(base));
+        base = nullptr;
+    }
+    header = nullptr;
+    file.close();
+}
+
+void InitialConditionsFile::readColumn(Column column, SimReal* out) const
+{
+    const uchar* data = base + align64(sizeof(InitialConditionsHeader)) + column * header->columnStride;
+    int count = particleCount();
+
+    if (isNativePrecision()) {
+        std::memcpy(out, data, count * sizeof(SimReal));
+    } else if (header->realSize == sizeof(float)) {
+        convertColumn<float>(data, count, out);
+    } else {
+        convertColumn<double>(data, count, out);
+    }
+}
+
+QRectF InitialConditionsFile::obstacle(int i) const
+{
+    double r[4];
+    std::memcpy(r, base + header->obstaclesOffset + i * sizeof(r), sizeof(r));
+    return QRectF(r[0], r[1], r[2], r[3]);
+}
+
+bool writeInitialConditions(const QString& filename, double boxWidth, double boxHeight,
+                            const ParticleStore& particles, const QVector<int>& order,
+                            const QVector<QRectF>& obstacles)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "No se pudo abrir el archivo para escritura:" << filename;
+        return false;
+    }
+
+    const bool gathered = !order.isEmpty();
+    const quint64 count = gathered ? order.size() : particles.size();
+    const quint64 columnBytes = count * sizeof(SimReal);
+    const quint64 firstColumn = align64(sizeof(InitialConditionsHeader));
+
+    InitialConditionsHeader header = {};
+    header.magic = conditionsMagic;
+    header.version = conditionsVersion;
+    header.realSize = sizeof(SimReal);
+    header.particleCount = count;
+    header.obstacleCount = obstacles.size();
+    header.boxWidth = boxWidth;
+    header.boxHeight = boxHeight;
+    header.columnStride = align64(columnBytes);
+    header.activeOffset = firstColumn + 6 * header.columnStride;
+    header.obstaclesOffset = align64(header.activeOffset + count);
+    header.fileBytes = header.obstaclesOffset + obstacles.size() * 4 * sizeof(double);
+
+    bool ok = file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header)
+              && writePadding(file, firstColumn - sizeof(header));
+
+    // Con un orden dado se reúne cada columna en un búfer antes de escribirla
+    QVector<SimReal> buffer;
+    if (gathered) buffer.resize(static_cast<int>(count));
+
+    const QVector<SimReal>* columns[6] = { &particles.x, &particles.y, &particles.vx,
+                                           &particles.vy, &particles.mass, &particles.radius };
+    for (int c = 0; c < 6 && ok; ++c) {
+        const SimReal* data = columns[c]->constData();
+        if (gathered) {
+            for (int k = 0; k < buffer.size(); ++k) buffer[k] = data[order[k]];
+            data = buffer.constData();
+        }
+        ok = file.write(reinterpret_cast<const char*>(data), columnBytes) == qint64(columnBytes)
+             && writePadding(file, header.columnStride - columnBytes);
+    }
+
+    if (ok) {
+        QVector<quint8> flags;
+        const quint8* active = particles.active.constData();
+        if (gathered) {
+            flags.resize(static_cast<int>(count));
+            for (int k = 0; k < flags.size(); ++k) flags[k] = active[order[k]];
+            active = flags.constData();
+        }
+        ok = file.write(reinterpret_cast<const char*>(active), count) == qint64(count)
+             && writePadding(file, header.obstaclesOffset - header.activeOffset - count);
+    }
+
+    for (int i = 0; i < obstacles.size() && ok; ++i) {
+        const QRectF& rect = obstacles[i];
+        double r[4] = { rect.x(), rect.y(), rect.width(), rect.height() };
+        ok = file.write(reinterpret_cast<const char*>(r), sizeof(r)) == sizeof(r);
+    }
+
+    if (!ok) {
+        qWarning() << "Error al escribir:" << filename << file.errorString();
+    }
+    file.close();
+    return ok;
+}
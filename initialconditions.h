@@ -0,0 +1,81 @@
+#ifndef INITIALCONDITIONS_H
+#define INITIALCONDITIONS_H
+
+#include "particlestore.h"
+#include "simreal.h"
+#include <QFile>
+#include <QRectF>
+#include <QString>
+#include <QVector>
+
+// Condiciones iniciales en binario, para cargar escenarios enormes sin
+// construir una Particle por partícula.
+//
+// Distribución (columnas alineadas a 64 bytes, en el orden de la máquina):
+//   InitialConditionsHeader
+//   x, y, vx, vy, mass, radius   (particleCount valores de realSize bytes)
+//   active                       (particleCount bytes)
+//   obstáculos                   (obstacleCount x 4 double: x, y, ancho, alto)
+//
+// Las columnas tienen el mismo formato que ParticleStore, así que la carga
+// es una copia por columna desde el archivo mapeado en memoria. Un archivo
+// escrito en otra precisión (float/double) también se acepta, convirtiendo.
+
+struct InitialConditionsHeader
+{
+    quint32 magic;          // 'P5IC'
+    quint32 version;
+    quint32 realSize;       // sizeof(SimReal) del escritor
+    quint32 reserved;
+    quint64 particleCount;
+    quint64 obstacleCount;
+    double boxWidth;
+    double boxHeight;
+    quint64 columnStride;   // bytes entre columnas reales consecutivas
+    quint64 activeOffset;
+    quint64 obstaclesOffset;
+    quint64 fileBytes;
+};
+
+// Columnas de un archivo de condiciones iniciales mapeado (solo lectura)
+class InitialConditionsFile
+{
+public:
+    InitialConditionsFile();
+    ~InitialConditionsFile();
+
+    bool open(const QString& filename);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    int particleCount() const { return header ? static_cast<int>(header->particleCount) : 0; }
+    int obstacleCount() const { return header ? static_cast<int>(header->obstacleCount) : 0; }
+    double boxWidth() const { return header ? header->boxWidth : 0.0; }
+    double boxHeight() const { return header ? header->boxHeight : 0.0; }
+    bool isNativePrecision() const { return header && header->realSize == sizeof(SimReal); }
+
+    enum Column { X, Y, VX, VY, Mass, Radius };
+
+    // Copia la columna al destino (particleCount valores), convirtiendo si
+    // el archivo se escribió en otra precisión
+    void readColumn(Column column, SimReal* out) const;
+    const quint8* activeFlags() const { return base + header->activeOffset; }
+    QRectF obstacle(int i) const;
+
+private:
+    QFile file;
+    const uchar* base;
+    const InitialConditionsHeader* header;
+
+    InitialConditionsFile(const InitialConditionsFile&);
+    InitialConditionsFile& operator=(const InitialConditionsFile&);
+};
+
+// Escribe las partículas de 'order' (posiciones del almacén; vacío = todas
+// en orden) y los obstáculos. Las columnas se escriben de una vez cuando no
+// hay que reordenar.
+bool writeInitialConditions(const QString& filename, double boxWidth, double boxHeight,
+                            const ParticleStore& particles, const QVector<int>& order,
+                            const QVector<QRectF>& obstacles);
+
+#endif // INITIALCONDITIONS_H
@@ -1,11 +1,55 @@
 #include <QCoreApplication>
 #include "simulator.h"
+#include "benchmark.h"
+#include "tournament.h"
+#include "runanalysis.h"
+#include "scenariogenerator.h"
 #include <QDebug>
+#include <cstring>
+
+#ifdef SIM_VIEWER
+#include <QApplication>
+#include "particleviewer.h"
+#endif
 
 int main(int argc, char *argv[])
 {
+#ifdef SIM_VIEWER
+    // Visor gráfico: --view archivo.txt  o  --view-live nombre
+    if (argc >= 3 && (std::strcmp(argv[1], "--view") == 0 || std::strcmp(argv[1], "--view-live") == 0)) {
+        QApplication app(argc, argv);
+        ParticleViewer viewer;
+        bool ok = (std::strcmp(argv[1], "--view") == 0)
+                      ? viewer.loadRecording(QString::fromLocal8Bit(argv[2]))
+                      : viewer.attachLive(QString::fromLocal8Bit(argv[2]));
+        viewer.show();
+        return ok ? app.exec() : 1;
+    }
+#endif
+
     QCoreApplication a(argc, argv);
 
+    // Modos de banco de pruebas (ver benchmark.h)
+    QStringList args = QCoreApplication::arguments();
+    if (args.contains("--bench")) {
+        return runBenchmarks(args);
+    }
+    if (args.contains("--tournament")) {
+        return runTournament(args);
+    }
+    if (args.contains("--analyze")) {
+        return runAnalysis(args);
+    }
+    if (args.contains("--generate")) {
+        return runGenerator(args);
+    }
+    if (args.size() >= 4 && args[1] == "--drift") {
+        return compareStates(args[2], args[3]);
+    }
+    if (args.size() >= 3 && args[1] == "--watch") {
+        return watchStateStream(args[2]);
+    }
+
     // Crear simulador
     // Caja de 800x600, dt = 0.01 segundos
     Simulator sim(800, 600, 0.01);
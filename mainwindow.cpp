@@ -3,15 +3,26 @@
 #include <QHBoxLayout>
 #include <QGroupBox>
 #include <QMessageBox>
+#include <QPainterPath>
+#include <QKeyEvent>
+
+namespace {
+const double frameStep = 0.016;     // ~60 FPS
+const int maxCachedPreviews = 4096;
+const int frameInterval = 16;       // ms pedidos al temporizador
+const char* const traceFile = "perfil_cuadros.json";
+}
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), projectileItem(nullptr)
+    : QMainWindow(parent), projectileItem(nullptr), debrisItem(nullptr), shotInFlight(false),
+    previewItem(nullptr), previewRevision(-1)
 {
     setupUI();
     setupGame();
 
     timer = new QTimer(this);
     connect(timer, &QTimer::timeout, this, &MainWindow::updateGame);
+    profiler.setExpectedInterval(frameInterval);
 }
 
 MainWindow::~MainWindow()
@@ -32,8 +43,9 @@ void MainWindow::setupUI()
     scene->setSceneRect(0, 0, 800, 600);
     scene->setBackgroundBrush(QBrush(QColor(135, 206, 235))); // Cielo azul
 
-    view = new QGraphicsView(scene);
+    view = new ProfiledView(scene);
     view->setRenderHint(QPainter::Antialiasing);
+    view->setProfiler(&profiler);
     mainLayout->addWidget(view);
 
     // Panel de controles
@@ -80,6 +92,8 @@ void MainWindow::setupUI()
     // Conexiones
     connect(angleSlider, &QSlider::valueChanged, this, &MainWindow::updateAngleLabel);
     connect(speedSlider, &QSlider::valueChanged, this, &MainWindow::updateSpeedLabel);
+    connect(angleSlider, &QSlider::valueChanged, this, &MainWindow::updateTrajectoryPreview);
+    connect(speedSlider, &QSlider::valueChanged, this, &MainWindow::updateTrajectoryPreview);
     connect(launchButton, &QPushButton::clicked, this, &MainWindow::launchProjectile);
 
     setWindowTitle("Juego de Estrategia Militar - Práctica 5");
@@ -89,6 +103,7 @@ void MainWindow::setupUI()
 void MainWindow::setupGame()
 {
     engine = new GameEngine(800, 600);
+    engine->setGroundLevel(550);
 
     // Infraestructura Jugador 1 (izquierda)
     engine->addInfrastructure(1, Infrastructure(50, 450, 40, 100, 200));
@@ -106,6 +121,8 @@ void MainWindow::setupGame()
 void MainWindow::renderScene()
 {
     scene->clear();
+    previewItem = nullptr;
+    debrisItem = nullptr;
     player1InfraItems.clear();
     player2InfraItems.clear();
     resistanceLabels1.clear();
@@ -117,33 +134,44 @@ void MainWindow::renderScene()
     // Dibujar infraestructura Jugador 1
     const QVector<Infrastructure>& infra1 = engine->getPlayer1Infrastructure();
     for (int i = 0; i < infra1.size(); ++i) {
-        if (!infra1[i].isDestroyed()) {
-            QRectF rect = infra1[i].getRect();
-            QGraphicsRectItem *item = scene->addRect(rect, QPen(Qt::black, 2), QBrush(QColor(70, 130, 180)));
-            player1InfraItems.append(item);
-
-            QGraphicsTextItem *label = scene->addText(QString::number((int)infra1[i].getResistance()));
-            label->setPos(rect.center().x() - 10, rect.center().y() - 10);
-            label->setDefaultTextColor(Qt::white);
-            resistanceLabels1.append(label);
+        if (infra1[i].isDestroyed()) {
+            player1InfraItems.append(nullptr);
+            resistanceLabels1.append(nullptr);
+            continue;
         }
+        QRectF rect = infra1[i].getRect();
+        QGraphicsRectItem *item = scene->addRect(rect, QPen(Qt::black, 2), QBrush(QColor(70, 130, 180)));
+        player1InfraItems.append(item);
+
+        QGraphicsTextItem *label = scene->addText(QString::number((int)infra1[i].getResistance()));
+        label->setPos(rect.center().x() - 10, rect.center().y() - 10);
+        label->setDefaultTextColor(Qt::white);
+        resistanceLabels1.append(label);
     }
 
     // Dibujar infraestructura Jugador 2
     const QVector<Infrastructure>& infra2 = engine->getPlayer2Infrastructure();
     for (int i = 0; i < infra2.size(); ++i) {
-        if (!infra2[i].isDestroyed()) {
-            QRectF rect = infra2[i].getRect();
-            QGraphicsRectItem *item = scene->addRect(rect, QPen(Qt::black, 2), QBrush(QColor(220, 20, 60)));
-            player2InfraItems.append(item);
-
-            QGraphicsTextItem *label = scene->addText(QString::number((int)infra2[i].getResistance()));
-            label->setPos(rect.center().x() - 10, rect.center().y() - 10);
-            label->setDefaultTextColor(Qt::white);
-            resistanceLabels2.append(label);
+        if (infra2[i].isDestroyed()) {
+            player2InfraItems.append(nullptr);
+            resistanceLabels2.append(nullptr);
+            continue;
         }
+        QRectF rect = infra2[i].getRect();
+        QGraphicsRectItem *item = scene->addRect(rect, QPen(Qt::black, 2), QBrush(QColor(220, 20, 60)));
+        player2InfraItems.append(item);
+
+        QGraphicsTextItem *label = scene->addText(QString::number((int)infra2[i].getResistance()));
+        label->setPos(rect.center().x() - 10, rect.center().y() - 10);
+        label->setDefaultTextColor(Qt::white);
+        resistanceLabels2.append(label);
     }
 
+    // Escombros: una sola capa para todos los pedazos, sobre los bloques
+    debrisItem = new DebrisLayer(&engine->getDebris(), 800, 600);
+    debrisItem->setZValue(0.5);
+    scene->addItem(debrisItem);
+
     // Etiquetas de jugadores
     QGraphicsTextItem *p1Label = scene->addText("JUGADOR 1");
     p1Label->setPos(50, 580);
@@ -156,45 +184,79 @@ void MainWindow::renderScene()
     p2Label->setPos(680, 580);
     p2Label->setDefaultTextColor(QColor(220, 20, 60));
     p2Label->setFont(font);
+
+    updateTrajectoryPreview();
 }
 
 void MainWindow::updateGame()
 {
-    bool projectileActive = engine->update(0.016); // ~60 FPS
+    profiler.beginFrame();
+
+    bool projectileActive;
+    bool debrisMoving;
+    bool debrisActive;
+    {
+        FrameProfiler::Scope scope(profiler, FrameProfiler::Physics);
+        projectileActive = shotInFlight && engine->update(frameStep);
+
+        // Los escombros siguen cayendo aunque el disparo haya terminado
+        debrisMoving = engine->getDebris().awakeCount() > 0;
+        debrisActive = engine->updateDebris(frameStep);
+    }
+
+    bool showGameOver = false;
+    {
+        FrameProfiler::Scope scope(profiler, FrameProfiler::SceneUpdate);
+        if (debrisItem && (debrisMoving || debrisActive)) debrisItem->refresh();
+
+        if (projectileActive) {
+            const Projectile *proj = engine->getActiveProjectile();
+            if (proj && proj->isActive()) {
+                QPointF pos = proj->getPosition();
 
-    if (projectileActive) {
-        const Projectile *proj = engine->getActiveProjectile();
-        if (proj && proj->isActive()) {
-            QPointF pos = proj->getPosition();
+                if (projectileItem == nullptr) {
+                    projectileItem = scene->addEllipse(0, 0, 16, 16,
+                                                       QPen(Qt::black), QBrush(Qt::black));
+                }
 
-            if (projectileItem == nullptr) {
-                projectileItem = scene->addEllipse(0, 0, 16, 16,
-                                                   QPen(Qt::black), QBrush(Qt::black));
+                projectileItem->setPos(pos.x() - 8, pos.y() - 8);
+                updateResistanceLabels();
+            }
+        } else if (shotInFlight) {
+            shotInFlight = false;
+            if (projectileItem) {
+                scene->removeItem(projectileItem);
+                delete projectileItem;
+                projectileItem = nullptr;
             }
 
-            projectileItem->setPos(pos.x() - 8, pos.y() - 8);
-            updateResistanceLabels();
-        }
-    } else {
-        if (projectileItem) {
-            scene->removeItem(projectileItem);
-            delete projectileItem;
-            projectileItem = nullptr;
+            launchButton->setEnabled(true);
+
+            if (engine->isGameOver()) {
+                updateTrajectoryPreview();
+                showGameOver = true;
+            } else {
+                playerLabel->setText(QString("Turno: Jugador %1").arg(engine->getCurrentPlayer()));
+                statusLabel->setText("Ajusta el ángulo y velocidad, luego presiona LANZAR");
+                renderScene();
+            }
         }
+    }
 
+    // El diálogo es modal: fuera de la medición de la escena
+    if (showGameOver) {
+        QMessageBox::information(this, "¡Juego Terminado!",
+                                 QString("¡Jugador %1 gana!").arg(engine->getWinner()));
+        statusLabel->setText("Juego terminado");
+    }
+
+    if (!projectileActive && !debrisActive) {
         timer->stop();
-        launchButton->setEnabled(true);
-
-        if (engine->isGameOver()) {
-            QMessageBox::information(this, "¡Juego Terminado!",
-                                     QString("¡Jugador %1 gana!").arg(engine->getWinner()));
-            statusLabel->setText("Juego terminado");
-        } else {
-            playerLabel->setText(QString("Turno: Jugador %1").arg(engine->getCurrentPlayer()));
-            statusLabel->setText("Ajusta el ángulo y velocidad, luego presiona LANZAR");
-            renderScene();
-        }
+        profiler.interrupt();
     }
+
+    // El panel cambia en cada cuadro aunque la escena no se haya movido
+    if (profiler.isEnabled()) view->viewport()->update();
 }
 
 void MainWindow::launchProjectile()
@@ -205,10 +267,12 @@ void MainWindow::launchProjectile()
     double speed = speedSlider->value();
 
     engine->launchProjectile(engine->getCurrentPlayer(), angle, speed);
+    shotInFlight = true;
 
     launchButton->setEnabled(false);
     statusLabel->setText("Proyectil en vuelo...");
-    timer->start(16); // ~60 FPS
+    updateTrajectoryPreview();
+    timer->start(frameInterval); // ~60 FPS
 }
 
 void MainWindow::updateAngleLabel(int value)
@@ -221,15 +285,106 @@ void MainWindow::updateSpeedLabel(int value)
     speedLabel->setText(QString("Velocidad: %1").arg(value));
 }
 
+void MainWindow::updateTrajectoryPreview()
+{
+    // Sin previsión con un proyectil en vuelo o con el juego terminado
+    if (engine->getActiveProjectile() != nullptr || engine->isGameOver()) {
+        if (previewItem) previewItem->hide();
+        return;
+    }
+
+    if (previewRevision != engine->getRevision() || previewCache.size() > maxCachedPreviews) {
+        previewCache.clear();
+        previewRevision = engine->getRevision();
+    }
+
+    int player = engine->getCurrentPlayer();
+    int angle = angleSlider->value();
+    int speed = speedSlider->value();
+    int key = (player << 20) | (angle << 10) | speed;
+
+    if (!previewCache.contains(key)) {
+        TrajectoryPreview preview;
+        engine->predictTrajectory(player, angle, speed, frameStep, preview);
+        previewCache.insert(key, preview);
+    }
+    const TrajectoryPreview& preview = previewCache[key];
+
+    QPainterPath path;
+    if (!preview.path.isEmpty()) {
+        path.moveTo(preview.path.first());
+        for (int i = 1; i < preview.path.size(); ++i) {
+            path.lineTo(preview.path[i]);
+        }
+    }
+    for (const QPointF& bounce : preview.bounces) {
+        path.addEllipse(bounce, 3, 3);
+    }
+
+    if (previewItem == nullptr) {
+        previewItem = scene->addPath(QPainterPath());
+        previewItem->setZValue(1);
+    }
+    QColor color = (player == 1) ? QColor(70, 130, 180) : QColor(220, 20, 60);
+    previewItem->setPen(QPen(color, 2, Qt::DashLine));
+    previewItem->setPath(path);
+    previewItem->show();
+}
+
 void MainWindow::updateResistanceLabels()
 {
+    // Un bloque destruido en vuelo desaparece de inmediato: sus escombros
+    // ya están en la escena
     const QVector<Infrastructure>& infra1 = engine->getPlayer1Infrastructure();
     for (int i = 0; i < resistanceLabels1.size() && i < infra1.size(); ++i) {
+        if (!resistanceLabels1[i]) continue;
         resistanceLabels1[i]->setPlainText(QString::number((int)infra1[i].getResistance()));
+        if (infra1[i].isDestroyed()) {
+            player1InfraItems[i]->hide();
+            resistanceLabels1[i]->hide();
+        }
     }
 
     const QVector<Infrastructure>& infra2 = engine->getPlayer2Infrastructure();
     for (int i = 0; i < resistanceLabels2.size() && i < infra2.size(); ++i) {
+        if (!resistanceLabels2[i]) continue;
         resistanceLabels2[i]->setPlainText(QString::number((int)infra2[i].getResistance()));
+        if (infra2[i].isDestroyed()) {
+            player2InfraItems[i]->hide();
+            resistanceLabels2[i]->hide();
+        }
+    }
+}
+
+void MainWindow::keyPressEvent(QKeyEvent *event)
+{
+    if (event->key() == Qt::Key_F3) {
+        profiler.setEnabled(!profiler.isEnabled());
+        view->viewport()->update();
+    } else if (event->key() == Qt::Key_F4) {
+        toggleTrace();
+    } else {
+        QMainWindow::keyPressEvent(event);
+    }
+}
+
+void MainWindow::toggleTrace()
+{
+    if (!profiler.isTracing()) {
+        profiler.startTrace();
+        statusLabel->setText("Grabando traza de cuadros (F4 para detener)...");
+        return;
+    }
+
+    profiler.stopTrace();
+    if (profiler.writeTrace(traceFile)) {
+        QString message = QString("Traza guardada en %1 (%2 eventos")
+                              .arg(traceFile).arg(profiler.traceEventCount());
+        if (profiler.droppedTraceEvents() > 0) {
+            message += QString(", %1 descartados").arg(profiler.droppedTraceEvents());
+        }
+        statusLabel->setText(message + ")");
+    } else {
+        statusLabel->setText(QString("No se pudo escribir %1").arg(traceFile));
     }
 }
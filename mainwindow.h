@@ -4,11 +4,19 @@
 #include <QMainWindow>
 #include <QGraphicsScene>
 #include <QGraphicsView>
+#include <QGraphicsRectItem>
+#include <QGraphicsEllipseItem>
+#include <QGraphicsTextItem>
 #include <QTimer>
 #include <QSlider>
 #include <QLabel>
 #include <QPushButton>
+#include <QGraphicsPathItem>
+#include <QHash>
 #include "gameengine.h"
+#include "debrislayer.h"
+#include "frameprofiler.h"
+#include "profiledview.h"
 
 class MainWindow : public QMainWindow
 {
@@ -18,16 +26,22 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+protected:
+    // F3: panel del perfilador; F4: iniciar/detener la traza
+    void keyPressEvent(QKeyEvent *event) override;
+
 private slots:
     void updateGame();
     void launchProjectile();
     void updateAngleLabel(int value);
     void updateSpeedLabel(int value);
+    void updateTrajectoryPreview();
 
 private:
     QGraphicsScene *scene;
-    QGraphicsView *view;
+    ProfiledView *view;
     QTimer *timer;
+    FrameProfiler profiler;
 
     QSlider *angleSlider;
     QSlider *speedSlider;
@@ -40,15 +54,27 @@ private:
     GameEngine *engine;
 
     QGraphicsEllipseItem *projectileItem;
+    DebrisLayer *debrisItem;
+    bool shotInFlight;        // los escombros pueden seguir cayendo después
+
+    // Alineados con la infraestructura de cada jugador (nullptr si el
+    // bloque ya estaba destruido al dibujar la escena)
     QVector<QGraphicsRectItem*> player1InfraItems;
     QVector<QGraphicsRectItem*> player2InfraItems;
     QVector<QGraphicsTextItem*> resistanceLabels1;
     QVector<QGraphicsTextItem*> resistanceLabels2;
 
+    // Trayectoria prevista del disparo, por (jugador, ángulo, velocidad);
+    // se descarta cuando cambia la revisión del motor
+    QGraphicsPathItem *previewItem;
+    QHash<int, TrajectoryPreview> previewCache;
+    int previewRevision;
+
     void setupUI();
     void setupGame();
     void renderScene();
     void updateResistanceLabels();
+    void toggleTrace();
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,48 @@
+#include "memoryarena.h"
+#include <cstdlib>
+
+MemoryArena::MemoryArena(qint64 budgetBytes)
+    : budget(budgetBytes), used(0), peak(0)
+{
+}
+
+MemoryArena::~MemoryArena()
+{
+    for (void* p : owned) {
+        std::free(p);
+    }
+}
+
+void* MemoryArena::allocateChunk(qint64 bytes)
+{
+    if (wouldExceed(bytes)) return nullptr;
+
+    void* chunk = nullptr;
+
+    // Reutilizar un bloque liberado del mismo tamaño antes de pedir memoria
+    for (int i = 0; i < freeChunks.size(); ++i) {
+        if (freeChunks[i].bytes == bytes) {
+            chunk = freeChunks[i].ptr;
+            freeChunks[i] = freeChunks.last();
+            freeChunks.removeLast();
+            break;
+        }
+    }
+
+    if (!chunk) {
+        chunk = std::malloc(static_cast<size_t>(bytes));
+        if (!chunk) return nullptr;
+        owned.append(chunk);
+    }
+
+    used += bytes;
+    if (used > peak) peak = used;
+    return chunk;
+}
+
+void MemoryArena::releaseChunk(void* chunk, qint64 bytes)
+{
+    FreeChunk f = { chunk, bytes };
+    freeChunks.append(f);
+    used -= bytes;
+}
@@ -0,0 +1,41 @@
+#ifndef MEMORYARENA_H
+#define MEMORYARENA_H
+
+#include <QtGlobal>
+#include <QVector>
+
+// Arena de bloques de tamaño fijo con presupuesto de memoria.
+// Lleva la cuenta de los bytes en uso y del pico alcanzado; cuando un
+// bloque nuevo excedería el presupuesto, allocateChunk retorna nullptr y es
+// el llamador quien decide si volcar a disco o abortar.
+class MemoryArena
+{
+public:
+    explicit MemoryArena(qint64 budgetBytes = 0);   // 0 = sin límite
+    ~MemoryArena();
+
+    void* allocateChunk(qint64 bytes);
+    void releaseChunk(void* chunk, qint64 bytes);
+
+    void setBudget(qint64 bytes) { budget = bytes; }
+    qint64 getBudget() const { return budget; }
+    qint64 getUsed() const { return used; }
+    qint64 getPeak() const { return peak; }
+
+    bool wouldExceed(qint64 bytes) const { return budget > 0 && used + bytes > budget; }
+
+private:
+    qint64 budget;
+    qint64 used;
+    qint64 peak;
+
+    // Bloques liberados, reutilizables por tamaño exacto
+    struct FreeChunk { void* ptr; qint64 bytes; };
+    QVector<FreeChunk> freeChunks;
+    QVector<void*> owned;
+
+    MemoryArena(const MemoryArena&);
+    MemoryArena& operator=(const MemoryArena&);
+};
+
+#endif // MEMORYARENA_H
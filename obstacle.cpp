@@ -1,6 +1,5 @@
 #include "obstacle.h"
-#include <cmath>
-#include <algorithm>
+#include "collisionkernels.h"
 
 Obstacle::Obstacle(double x, double y, double w, double h)
     : rect(x, y, w, h)
@@ -9,31 +8,14 @@ Obstacle::Obstacle(double x, double y, double w, double h)
 
 bool Obstacle::checkCollision(const QPointF& center, double radius) const
 {
-    // Encontrar el punto más cercano del rectángulo al círculo
-    double closestX = std::max(rect.left(), std::min(center.x(), rect.right()));
-    double closestY = std::max(rect.top(), std::min(center.y(), rect.bottom()));
-
-    // Calcular distancia
-    double dx = center.x() - closestX;
-    double dy = center.y() - closestY;
-    double distance = std::sqrt(dx * dx + dy * dy);
-
-    return distance < radius;
+    // Punto más cercano del rectángulo comparado con distancias al cuadrado
+    return circleHitsRect(center.x(), center.y(), radius,
+                          rect.left(), rect.top(), rect.right(), rect.bottom());
 }
 
 int Obstacle::getCollisionSide(const QPointF& center, const QPointF& prevCenter) const
 {
-    // Calcular distancias a cada lado
-    double distTop = std::abs(center.y() - rect.top());
-    double distBottom = std::abs(center.y() - rect.bottom());
-    double distLeft = std::abs(center.x() - rect.left());
-    double distRight = std::abs(center.x() - rect.right());
-
-    // Encontrar la distancia mínima
-    double minDist = std::min({distTop, distBottom, distLeft, distRight});
-
-    if (minDist == distTop) return 0;      // arriba
-    if (minDist == distRight) return 1;    // derecha
-    if (minDist == distBottom) return 2;   // abajo
-    return 3;                               // izquierda
+    Q_UNUSED(prevCenter);
+    return rectCollisionSide(center.x(), center.y(),
+                             rect.left(), rect.top(), rect.right(), rect.bottom());
 }
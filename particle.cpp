@@ -1,8 +1,8 @@
 #include "particle.h"
 #include <cmath>
 
-Particle::Particle(double x, double y, double vx, double vy, double m, double r)
-    : position(x, y), velocity(vx, vy), mass(m), radius(r), active(true)
+Particle::Particle(double px, double py, double pvx, double pvy, double m, double r)
+    : x(px), y(py), vx(pvx), vy(pvy), mass(m), radius(r), active(true)
 {
 }
 
@@ -11,8 +11,8 @@ void Particle::updatePosition(double dt)
     if (!active) return;
 
     // Actualizar posición usando velocidad actual
-    position.setX(position.x() + velocity.x() * dt);
-    position.setY(position.y() + velocity.y() * dt);
+    x += vx * static_cast<SimReal>(dt);
+    y += vy * static_cast<SimReal>(dt);
 }
 
 bool Particle::checkCollisionWithParticle(const Particle& other) const
@@ -20,9 +20,9 @@ bool Particle::checkCollisionWithParticle(const Particle& other) const
     if (!active || !other.active) return false;
 
     // Calcular distancia entre centros
-    double dx = position.x() - other.position.x();
-    double dy = position.y() - other.position.y();
-    double distance = std::sqrt(dx * dx + dy * dy);
+    SimReal dx = x - other.x;
+    SimReal dy = y - other.y;
+    SimReal distance = std::sqrt(dx * dx + dy * dy);
 
     // Colisión si la distancia es menor que la suma de radios
     return distance < (radius + other.radius);
@@ -31,20 +31,20 @@ bool Particle::checkCollisionWithParticle(const Particle& other) const
 Particle Particle::merge(const Particle& p1, const Particle& p2)
 {
     // Conservación del momento lineal: m1*v1 + m2*v2 = (m1+m2)*v'
-    double totalMass = p1.mass + p2.mass;
+    SimReal totalMass = p1.mass + p2.mass;
 
     // Calcular nueva velocidad usando conservación del momento
-    double newVx = (p1.mass * p1.velocity.x() + p2.mass * p2.velocity.x()) / totalMass;
-    double newVy = (p1.mass * p1.velocity.y() + p2.mass * p2.velocity.y()) / totalMass;
+    SimReal newVx = (p1.mass * p1.vx + p2.mass * p2.vx) / totalMass;
+    SimReal newVy = (p1.mass * p1.vy + p2.mass * p2.vy) / totalMass;
 
     // Calcular posición del centro de masa
-    double newX = (p1.mass * p1.position.x() + p2.mass * p2.position.x()) / totalMass;
-    double newY = (p1.mass * p1.position.y() + p2.mass * p2.position.y()) / totalMass;
+    SimReal newX = (p1.mass * p1.x + p2.mass * p2.x) / totalMass;
+    SimReal newY = (p1.mass * p1.y + p2.mass * p2.y) / totalMass;
 
     // Calcular nuevo radio conservando aproximadamente el área
     // Área total = π*r1² + π*r2² = π*r'²
     // r' = sqrt(r1² + r2²)
-    double newRadius = std::sqrt(p1.radius * p1.radius + p2.radius * p2.radius);
+    SimReal newRadius = std::sqrt(p1.radius * p1.radius + p2.radius * p2.radius);
 
     // Crear y retornar la nueva partícula fusionada
     return Particle(newX, newY, newVx, newVy, totalMass, newRadius);
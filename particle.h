@@ -1,6 +1,7 @@
 #ifndef PARTICLE_H
 #define PARTICLE_H
 
+#include "simreal.h"
 #include <QPointF>
 #include <QVector>
 
@@ -10,15 +11,15 @@ public:
     Particle(double x, double y, double vx, double vy, double mass, double radius);
 
     // Getters
-    QPointF getPosition() const { return position; }
-    QPointF getVelocity() const { return velocity; }
+    QPointF getPosition() const { return QPointF(x, y); }
+    QPointF getVelocity() const { return QPointF(vx, vy); }
     double getMass() const { return mass; }
     double getRadius() const { return radius; }
     bool isActive() const { return active; }
 
     // Setters
-    void setPosition(const QPointF& pos) { position = pos; }
-    void setVelocity(const QPointF& vel) { velocity = vel; }
+    void setPosition(const QPointF& pos) { x = pos.x(); y = pos.y(); }
+    void setVelocity(const QPointF& vel) { vx = vel.x(); vy = vel.y(); }
     void setMass(double m) { mass = m; }
     void setRadius(double r) { radius = r; }
     void setActive(bool a) { active = a; }
@@ -33,10 +34,10 @@ public:
     static Particle merge(const Particle& p1, const Particle& p2);
 
 private:
-    QPointF position;  // (x, y)
-    QPointF velocity;  // (vx, vy)
-    double mass;
-    double radius;
+    SimReal x, y;      // posición
+    SimReal vx, vy;    // velocidad
+    SimReal mass;
+    SimReal radius;
     bool active;       // false si la partícula se fusionó con otra
 };
 
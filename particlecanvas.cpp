@@ -0,0 +1,219 @@
+#include "particlecanvas.h"
+#include <QPainter>
+#include <QWheelEvent>
+#include <QMouseEvent>
+#include <QResizeEvent>
+#include <cmath>
+
+namespace {
+
+const quint32 backgroundColor = 0xff101820;
+const quint32 particleColor = 0xffffc04d;
+const int maxSpanRadius = 8;   // píxeles; por encima se usa QPainter
+
+} // namespace
+
+ParticleCanvas::ParticleCanvas(QWidget *parent)
+    : QWidget(parent), worldWidth(800), worldHeight(600),
+    zoom(1.0), viewCenter(400, 300), dragging(false),
+    drawnCount(0), culledCount(0), frameTime(0.0)
+{
+    setMinimumSize(400, 300);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void ParticleCanvas::setWorld(double width, double height)
+{
+    worldWidth = width;
+    worldHeight = height;
+    viewCenter = QPointF(width / 2, height / 2);
+    zoom = 1.0;
+}
+
+void ParticleCanvas::setObstacles(const QVector<QRectF>& rects)
+{
+    obstacles = rects;
+}
+
+double ParticleCanvas::viewScale() const
+{
+    return std::min(width() / worldWidth, height() / worldHeight) * zoom;
+}
+
+void ParticleCanvas::fillDisk(quint32* bits, int stride, double cx, double cy, double r, quint32 color)
+{
+    const int w = image.width();
+    const int h = image.height();
+    int y0 = std::max(0, static_cast<int>(std::ceil(cy - r)));
+    int y1 = std::min(h - 1, static_cast<int>(std::floor(cy + r)));
+
+    for (int py = y0; py <= y1; ++py) {
+        double dy = py - cy;
+        double half = std::sqrt(std::max(0.0, r * r - dy * dy));
+        int x0 = std::max(0, static_cast<int>(std::ceil(cx - half)));
+        int x1 = std::min(w - 1, static_cast<int>(std::floor(cx + half)));
+        quint32* row = bits + py * stride;
+        for (int px = x0; px <= x1; ++px) {
+            row[px] = color;
+        }
+    }
+}
+
+void ParticleCanvas::drawFrame(const ParticleFrame& frame)
+{
+    const int w = width();
+    const int h = height();
+    if (w <= 0 || h <= 0) return;
+
+    if (image.size() != size()) {
+        image = QImage(size(), QImage::Format_RGB32);
+        density.resize(w * h);
+    }
+    image.fill(backgroundColor);
+    density.fill(0);
+    largeParticles.clear();
+
+    const double scale = viewScale();
+    const double ox = w * 0.5 - viewCenter.x() * scale;
+    const double oy = h * 0.5 - viewCenter.y() * scale;
+
+    quint32* bits = reinterpret_cast<quint32*>(image.bits());
+    const int stride = image.bytesPerLine() / 4;
+
+    drawnCount = 0;
+    culledCount = 0;
+    frameTime = frame.time;
+
+    // Una sola pasada sobre los arreglos del cuadro
+    for (int i = 0; i < frame.count; ++i) {
+        if (frame.active && !frame.active[i]) continue;
+
+        double r = (frame.radius ? frame.radius[i] : frame.defaultRadius) * scale;
+        double sx = frame.x[i] * scale + ox;
+        double sy = frame.y[i] * scale + oy;
+
+        if (sx + r < 0 || sx - r >= w || sy + r < 0 || sy - r >= h) {
+            culledCount++;
+            continue;
+        }
+        drawnCount++;
+
+        if (r < 1.0) {
+            int px = static_cast<int>(sx);
+            int py = static_cast<int>(sy);
+            if (px >= 0 && px < w && py >= 0 && py < h) {
+                density[py * w + px]++;
+            }
+        } else if (r <= maxSpanRadius) {
+            fillDisk(bits, stride, sx, sy, r, particleColor);
+        } else {
+            largeParticles.append(i);
+        }
+    }
+
+    // Mapa de densidad: brillo logarítmico según partículas por píxel
+    for (int py = 0; py < h; ++py) {
+        const quint32* d = density.constData() + py * w;
+        quint32* row = bits + py * stride;
+        for (int px = 0; px < w; ++px) {
+            if (!d[px]) continue;
+            int level = std::min(255, 96 + static_cast<int>(40.0 * std::log2(1.0 + d[px])));
+            row[px] = 0xff000000u | (quint32(level) << 16) | (quint32(level * 3 / 4) << 8) | quint32(level / 4);
+        }
+    }
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    // Borde de la caja y obstáculos
+    painter.setPen(QPen(QColor(200, 200, 200), 1));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRect(QRectF(ox, oy, worldWidth * scale, worldHeight * scale));
+
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(90, 110, 140));
+    for (const QRectF& rect : obstacles) {
+        painter.drawRect(QRectF(rect.x() * scale + ox, rect.y() * scale + oy,
+                                rect.width() * scale, rect.height() * scale));
+    }
+
+    // Partículas grandes: pocas, se dibujan con antialiasing
+    painter.setBrush(QColor(particleColor));
+    for (int i : largeParticles) {
+        double r = (frame.radius ? frame.radius[i] : frame.defaultRadius) * scale;
+        painter.drawEllipse(QPointF(frame.x[i] * scale + ox, frame.y[i] * scale + oy), r, r);
+    }
+    painter.end();
+
+    update();
+}
+
+void ParticleCanvas::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    if (image.isNull()) {
+        painter.fillRect(rect(), QColor(backgroundColor));
+        return;
+    }
+    painter.drawImage(0, 0, image);
+
+    painter.setPen(Qt::white);
+    painter.drawText(10, 20, QString("t=%1 s  dibujadas=%2  descartadas=%3  zoom=%4x")
+                                 .arg(frameTime, 0, 'f', 2)
+                                 .arg(drawnCount)
+                                 .arg(culledCount)
+                                 .arg(zoom, 0, 'f', 1));
+}
+
+void ParticleCanvas::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    emit viewChanged();
+}
+
+void ParticleCanvas::wheelEvent(QWheelEvent *event)
+{
+    // Acercar manteniendo fijo el punto bajo el cursor
+    double scale = viewScale();
+    QPointF cursor = event->position();
+    QPointF world((cursor.x() - width() * 0.5) / scale + viewCenter.x(),
+                  (cursor.y() - height() * 0.5) / scale + viewCenter.y());
+
+    double factor = event->angleDelta().y() > 0 ? 1.25 : 0.8;
+    zoom = std::max(1.0, std::min(1000.0, zoom * factor));
+
+    double newScale = viewScale();
+    viewCenter = QPointF(world.x() - (cursor.x() - width() * 0.5) / newScale,
+                         world.y() - (cursor.y() - height() * 0.5) / newScale);
+    emit viewChanged();
+}
+
+void ParticleCanvas::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        dragging = true;
+        lastMousePos = event->pos();
+    }
+}
+
+void ParticleCanvas::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!dragging) return;
+
+    QPoint delta = event->pos() - lastMousePos;
+    lastMousePos = event->pos();
+
+    double scale = viewScale();
+    viewCenter = QPointF(viewCenter.x() - delta.x() / scale,
+                         viewCenter.y() - delta.y() / scale);
+    emit viewChanged();
+}
+
+void ParticleCanvas::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        dragging = false;
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef PARTICLECANVAS_H
+#define PARTICLECANVAS_H
+
+#include "simreal.h"
+#include <QWidget>
+#include <QImage>
+#include <QRectF>
+#include <QVector>
+
+// Cuadro a dibujar: arreglos separados (SoA) tal como los guarda el
+// simulador, el flujo en memoria compartida o una corrida grabada.
+struct ParticleFrame
+{
+    int count;
+    const SimReal* x;
+    const SimReal* y;
+    const SimReal* radius;    // nullptr = usar defaultRadius
+    const quint8* active;     // nullptr = todas activas
+    SimReal defaultRadius;
+    double time;
+};
+
+// Lienzo que rasteriza todas las partículas en una QImage en una sola
+// pasada de CPU, sin un QGraphicsItem por partícula. Nivel de detalle:
+//  - fuera de la vista: se descartan
+//  - radio en pantalla < 1 px: se acumulan en un mapa de densidad
+//  - radio pequeño: disco rellenado por líneas directamente en la imagen
+//  - radio grande (pocas, p. ej. tras muchas fusiones): QPainter
+// Rueda del ratón para acercar, arrastrar para desplazar.
+class ParticleCanvas : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ParticleCanvas(QWidget *parent = nullptr);
+
+    void setWorld(double width, double height);
+    void setObstacles(const QVector<QRectF>& rects);
+
+    // Rasteriza el cuadro de inmediato; los punteros no se conservan
+    void drawFrame(const ParticleFrame& frame);
+
+    int lastDrawnCount() const { return drawnCount; }
+
+signals:
+    // La vista cambió (zoom, desplazamiento, tamaño): redibujar el cuadro
+    void viewChanged();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+
+private:
+    double worldWidth;
+    double worldHeight;
+    QVector<QRectF> obstacles;
+
+    QImage image;
+    QVector<quint32> density;   // conteo por píxel para el nivel de detalle mínimo
+    QVector<int> largeParticles;
+
+    double zoom;
+    QPointF viewCenter;         // en coordenadas del mundo
+    bool dragging;
+    QPoint lastMousePos;
+
+    int drawnCount;
+    int culledCount;
+    double frameTime;
+
+    double viewScale() const;
+    void fillDisk(quint32* bits, int stride, double cx, double cy, double r, quint32 color);
+};
+
+#endif // PARTICLECANVAS_H
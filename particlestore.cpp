@@ -0,0 +1,44 @@
+#include "particlestore.h"
+
+void ParticleStore::reserve(int n)
+{
+    x.reserve(n);
+    y.reserve(n);
+    vx.reserve(n);
+    vy.reserve(n);
+    mass.reserve(n);
+    radius.reserve(n);
+    active.reserve(n);
+}
+
+void ParticleStore::resize(int n)
+{
+    x.resize(n);
+    y.resize(n);
+    vx.resize(n);
+    vy.resize(n);
+    mass.resize(n);
+    radius.resize(n);
+    active.resize(n);
+}
+
+void ParticleStore::append(const Particle& p)
+{
+    QPointF pos = p.getPosition();
+    QPointF vel = p.getVelocity();
+
+    x.append(pos.x());
+    y.append(pos.y());
+    vx.append(vel.x());
+    vy.append(vel.y());
+    mass.append(p.getMass());
+    radius.append(p.getRadius());
+    active.append(p.isActive() ? 1 : 0);
+}
+
+Particle ParticleStore::get(int i) const
+{
+    Particle p(x[i], y[i], vx[i], vy[i], mass[i], radius[i]);
+    p.setActive(active[i] != 0);
+    return p;
+}
@@ -0,0 +1,29 @@
+#ifndef PARTICLESTORE_H
+#define PARTICLESTORE_H
+
+#include "particle.h"
+#include "simreal.h"
+#include <QVector>
+
+// Almacenamiento de partículas del simulador en estructura de arreglos:
+// cada magnitud en un arreglo contiguo de SimReal para que los recorridos
+// del paso de tiempo lean solo lo que usan y se vectoricen.
+struct ParticleStore
+{
+    QVector<SimReal> x, y;
+    QVector<SimReal> vx, vy;
+    QVector<SimReal> mass;
+    QVector<SimReal> radius;
+    QVector<quint8> active;   // 0 si la partícula se fusionó con otra
+
+    int size() const { return x.size(); }
+
+    void reserve(int n);
+    void resize(int n);
+    void append(const Particle& p);
+
+    // Copia de la partícula i como objeto (para merge y consultas)
+    Particle get(int i) const;
+};
+
+#endif // PARTICLESTORE_H
@@ -0,0 +1,145 @@
+#include "particleviewer.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+
+ParticleViewer::ParticleViewer(QWidget *parent)
+    : QWidget(parent), hasRecording(false), playing(false), lastLiveFrame(0)
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    canvas = new ParticleCanvas(this);
+    mainLayout->addWidget(canvas, 1);
+
+    // Controles de reproducción
+    QHBoxLayout *controlLayout = new QHBoxLayout();
+    playButton = new QPushButton("Reproducir");
+    scrubber = new QSlider(Qt::Horizontal);
+    scrubber->setRange(0, 0);
+    infoLabel = new QLabel("Sin datos");
+    controlLayout->addWidget(playButton);
+    controlLayout->addWidget(scrubber, 1);
+    controlLayout->addWidget(infoLabel);
+    mainLayout->addLayout(controlLayout);
+
+    timer = new QTimer(this);
+
+    connect(timer, &QTimer::timeout, this, &ParticleViewer::tick);
+    connect(scrubber, &QSlider::valueChanged, this, &ParticleViewer::showRecordedFrame);
+    connect(playButton, &QPushButton::clicked, this, &ParticleViewer::togglePlayback);
+    connect(canvas, &ParticleCanvas::viewChanged, this, &ParticleViewer::redraw);
+
+    setWindowTitle("Visor de simulación - Práctica 5");
+    resize(1000, 800);
+}
+
+bool ParticleViewer::loadRecording(const QString& filename)
+{
+    if (!recording.loadExport(filename) || recording.frameCount() == 0) {
+        infoLabel->setText("No se pudo cargar " + filename);
+        return false;
+    }
+
+    hasRecording = true;
+    canvas->setWorld(recording.getBoxWidth(), recording.getBoxHeight());
+    canvas->setObstacles(recording.getObstacles());
+    scrubber->setRange(0, recording.frameCount() - 1);
+    scrubber->setValue(0);
+    showRecordedFrame(0);
+    return true;
+}
+
+bool ParticleViewer::attachLive(const QString& streamName)
+{
+    if (!liveStream.attach(streamName)) {
+        infoLabel->setText("Flujo no disponible: " + streamName);
+        return false;
+    }
+
+    canvas->setWorld(liveStream.boxWidth(), liveStream.boxHeight());
+    scrubber->setEnabled(false);
+    playButton->setEnabled(false);
+    timer->start(16);
+    return true;
+}
+
+void ParticleViewer::tick()
+{
+    if (liveStream.isAttached()) {
+        drawLiveFrame(false);
+        return;
+    }
+
+    if (playing && hasRecording) {
+        int next = scrubber->value() + 1;
+        if (next >= recording.frameCount()) {
+            togglePlayback();
+            return;
+        }
+        scrubber->setValue(next);
+    }
+}
+
+void ParticleViewer::showRecordedFrame(int frame)
+{
+    if (!hasRecording || frame < 0 || frame >= recording.frameCount()) return;
+
+    ParticleFrame f;
+    f.count = recording.frameSize(frame);
+    f.x = recording.frameX(frame);
+    f.y = recording.frameY(frame);
+    f.radius = nullptr;
+    f.active = nullptr;
+    f.defaultRadius = defaultRadius;
+    f.time = recording.frameTime(frame);
+    canvas->drawFrame(f);
+
+    infoLabel->setText(QString("Cuadro %1/%2  (%3 partículas)")
+                           .arg(frame + 1).arg(recording.frameCount()).arg(f.count));
+}
+
+void ParticleViewer::togglePlayback()
+{
+    playing = !playing;
+    playButton->setText(playing ? "Pausa" : "Reproducir");
+
+    if (playing) {
+        if (scrubber->value() >= recording.frameCount() - 1) scrubber->setValue(0);
+        timer->start(16);
+    } else {
+        timer->stop();
+    }
+}
+
+void ParticleViewer::redraw()
+{
+    if (liveStream.isAttached()) {
+        drawLiveFrame(true);
+    } else {
+        showRecordedFrame(scrubber->value());
+    }
+}
+
+void ParticleViewer::drawLiveFrame(bool force)
+{
+    StateFrameView view;
+    if (!liveStream.latest(view)) return;
+    if (!force && view.frame == lastLiveFrame) return;
+
+    // Se dibuja directamente desde la memoria compartida, sin copiar
+    ParticleFrame f;
+    f.count = view.count;
+    f.x = view.x;
+    f.y = view.y;
+    f.radius = view.radius;
+    f.active = view.active;
+    f.defaultRadius = defaultRadius;
+    f.time = view.time;
+    canvas->drawFrame(f);
+
+    // Si el simulador reescribió la ranura a mitad, se repite en el siguiente tick
+    if (!liveStream.isValid(view)) return;
+
+    lastLiveFrame = view.frame;
+    infoLabel->setText(QString("En vivo: cuadro %1  (%2 partículas)")
+                           .arg(view.frame).arg(canvas->lastDrawnCount()));
+}
@@ -0,0 +1,50 @@
+#ifndef PARTICLEVIEWER_H
+#define PARTICLEVIEWER_H
+
+#include "particlecanvas.h"
+#include "recordedrun.h"
+#include "statestream.h"
+#include <QWidget>
+#include <QTimer>
+#include <QSlider>
+#include <QLabel>
+#include <QPushButton>
+
+// Visor de corridas del Simulator: reproduce una exportación con una barra
+// de desplazamiento o sigue en vivo el flujo de memoria compartida.
+class ParticleViewer : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ParticleViewer(QWidget *parent = nullptr);
+
+    bool loadRecording(const QString& filename);
+    bool attachLive(const QString& streamName);
+
+private slots:
+    void tick();
+    void showRecordedFrame(int frame);
+    void togglePlayback();
+    void redraw();
+
+private:
+    ParticleCanvas *canvas;
+    QSlider *scrubber;
+    QPushButton *playButton;
+    QLabel *infoLabel;
+    QTimer *timer;
+
+    RecordedRun recording;
+    bool hasRecording;
+    bool playing;
+
+    StateStreamReader liveStream;
+    quint64 lastLiveFrame;
+
+    static const int defaultRadius = 2;
+
+    void drawLiveFrame(bool force);
+};
+
+#endif // PARTICLEVIEWER_H
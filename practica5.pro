@@ -1,6 +1,6 @@
 QT -= gui
 
-CONFIG += c++11 console
+CONFIG += c++17 console
 CONFIG -= app_bundle
 
 # Para que la consola permanezca abierta en Windows
@@ -11,13 +11,72 @@ SOURCES += \
     particle.cpp \
     obstacle.cpp \
     box.cpp \
-    simulator.cpp
+    particlestore.cpp \
+    memoryarena.cpp \
+    statestream.cpp \
+    recordedrun.cpp \
+    workerpool.cpp \
+    runstatistics.cpp \
+    broadphasegrid.cpp \
+    initialconditions.cpp \
+    scenariogenerator.cpp \
+    simulator.cpp \
+    domaindecomposition.cpp \
+    benchmark.cpp \
+    runanalysis.cpp \
+    projectile.cpp \
+    infranstructure.cpp \
+    infrastructuregrid.cpp \
+    debrissystem.cpp \
+    gameengine.cpp \
+    tournament.cpp
 
 HEADERS += \
     particle.h \
     obstacle.h \
     box.h \
-    simulator.h
+    collisionkernels.h \
+    particlestore.h \
+    memoryarena.h \
+    chunkedvector.h \
+    statestream.h \
+    recordedrun.h \
+    workerpool.h \
+    simreal.h \
+    runstatistics.h \
+    broadphasegrid.h \
+    initialconditions.h \
+    scenariogenerator.h \
+    simulator.h \
+    stepkernels.h \
+    domaindecomposition.h \
+    benchmark.h \
+    binaryexport.h \
+    runanalysis.h \
+    projectile.h \
+    infranstructure.h \
+    infrastructuregrid.h \
+    debrissystem.h \
+    gameengine.h \
+    tournament.h
+
+# Precisión del núcleo: qmake CONFIG+=sim_float para compilar en float
+sim_float {
+    DEFINES += SIM_SINGLE_PRECISION
+    TARGET = practica5_float
+}
+
+# Visor gráfico de corridas: qmake CONFIG+=sim_viewer (--view / --view-live)
+sim_viewer {
+    QT += gui widgets
+    CONFIG -= console
+    DEFINES += SIM_VIEWER
+    SOURCES += particlecanvas.cpp particleviewer.cpp
+    HEADERS += particlecanvas.h particleviewer.h
+}
+
+# Memoria compartida POSIX (shm_open) en Linux
+unix:!macx: LIBS += -lrt
 
 # Directorio de salida
 DESTDIR = $$PWD
@@ -0,0 +1,123 @@
+#include "profiledview.h"
+#include <QPainter>
+
+namespace {
+
+const int panelWidth = 300;
+const int graphHeight = 80;
+const double graphScaleMs = 50.0;    // alto del gráfico en milisegundos
+const double targetFrameMs = 1000.0 / 60.0;
+
+// Color de cada sección en las barras apiladas
+const QColor sectionColors[FrameProfiler::SectionCount] = {
+    QColor(255, 140, 0),     // Física
+    QColor(60, 179, 113),    // Escena
+    QColor(100, 149, 237)    // Pintado
+};
+
+double toMs(qint64 ns)
+{
+    return ns / 1.0e6;
+}
+
+} // namespace
+
+ProfiledView::ProfiledView(QGraphicsScene *scene, QWidget *parent)
+    : QGraphicsView(scene, parent), profiler(nullptr)
+{
+}
+
+void ProfiledView::setProfiler(FrameProfiler *profiler)
+{
+    this->profiler = profiler;
+}
+
+void ProfiledView::paintEvent(QPaintEvent *event)
+{
+    if (!profiler) {
+        QGraphicsView::paintEvent(event);
+        return;
+    }
+
+    FrameProfiler::Scope scope(*profiler, FrameProfiler::Paint);
+    QGraphicsView::paintEvent(event);
+}
+
+void ProfiledView::drawForeground(QPainter *painter, const QRectF &rect)
+{
+    QGraphicsView::drawForeground(painter, rect);
+
+    if (profiler && profiler->isEnabled()) {
+        // En coordenadas del viewport, no de la escena
+        painter->save();
+        painter->resetTransform();
+        drawOverlay(painter);
+        painter->restore();
+    }
+}
+
+void ProfiledView::drawOverlay(QPainter *painter)
+{
+    const int left = 10;
+    const int top = 10;
+    const int lineHeight = 15;
+    const int textLines = FrameProfiler::SectionCount + 3;
+    const int panelHeight = graphHeight + 16 + textLines * lineHeight;
+
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    painter->fillRect(left, top, panelWidth, panelHeight, QColor(0, 0, 0, 170));
+
+    // Un píxel por cuadro, el más reciente a la derecha
+    const int graphLeft = left + 8;
+    const int graphBottom = top + 8 + graphHeight;
+    const int graphWidth = panelWidth - 16;
+    const double pxPerMs = graphHeight / graphScaleMs;
+    const int count = profiler->frameCount();
+    const int first = qMax(0, count - graphWidth);
+
+    for (int i = first; i < count; ++i) {
+        const int x = graphLeft + graphWidth - (count - i);
+
+        // Cuadro completo en gris; encima las secciones medidas
+        int frameHeight = qMin(graphHeight, static_cast<int>(toMs(profiler->frameTime(i)) * pxPerMs));
+        painter->fillRect(x, graphBottom - frameHeight, 1, frameHeight, QColor(128, 128, 128));
+
+        int y = graphBottom;
+        for (int s = 0; s < FrameProfiler::SectionCount; ++s) {
+            FrameProfiler::Section section = static_cast<FrameProfiler::Section>(s);
+            int h = static_cast<int>(toMs(profiler->sample(section, i)) * pxPerMs + 0.5);
+            h = qMin(h, y - (graphBottom - graphHeight));
+            if (h <= 0) continue;
+            painter->fillRect(x, y - h, 1, h, sectionColors[s]);
+            y -= h;
+        }
+    }
+
+    const int targetY = graphBottom - static_cast<int>(targetFrameMs * pxPerMs);
+    painter->setPen(QPen(QColor(255, 255, 255, 160), 1, Qt::DashLine));
+    painter->drawLine(graphLeft, targetY, graphLeft + graphWidth, targetY);
+
+    // Percentiles de todo el historial
+    int y = graphBottom + 8 + lineHeight;
+    painter->setPen(Qt::white);
+    painter->drawText(left + 8, y, QString("%1 cuadros   p50 / p99 (ms)").arg(count));
+    y += lineHeight;
+    painter->drawText(left + 8, y, QString("Cuadro   %1 / %2")
+                                       .arg(toMs(profiler->frameTimePercentile(50)), 0, 'f', 2)
+                                       .arg(toMs(profiler->frameTimePercentile(99)), 0, 'f', 2));
+    for (int s = 0; s < FrameProfiler::SectionCount; ++s) {
+        FrameProfiler::Section section = static_cast<FrameProfiler::Section>(s);
+        y += lineHeight;
+        painter->setPen(sectionColors[s]);
+        painter->drawText(left + 8, y, QString("%1   %2 / %3")
+                                           .arg(QString::fromUtf8(FrameProfiler::sectionName(section)))
+                                           .arg(toMs(profiler->sectionPercentile(section, 50)), 0, 'f', 2)
+                                           .arg(toMs(profiler->sectionPercentile(section, 99)), 0, 'f', 2));
+    }
+    y += lineHeight;
+    painter->setPen(Qt::white);
+    painter->drawText(left + 8, y, QString("Retraso   %1 / %2%3")
+                                       .arg(toMs(profiler->jitterPercentile(50)), 0, 'f', 2)
+                                       .arg(toMs(profiler->jitterPercentile(99)), 0, 'f', 2)
+                                       .arg(profiler->isTracing() ? "   [traza]" : ""));
+}
@@ -0,0 +1,28 @@
+#ifndef PROFILEDVIEW_H
+#define PROFILEDVIEW_H
+
+#include "frameprofiler.h"
+#include <QGraphicsView>
+
+// Vista de la escena que mide su propio pintado (sección Paint del
+// FrameProfiler) y, con el perfilador encendido, dibuja encima el panel:
+// barras de los últimos cuadros apiladas por sección, la línea de 60 FPS y
+// los percentiles p50/p99 de cada medida.
+class ProfiledView : public QGraphicsView
+{
+public:
+    explicit ProfiledView(QGraphicsScene *scene, QWidget *parent = nullptr);
+
+    void setProfiler(FrameProfiler *profiler);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void drawForeground(QPainter *painter, const QRectF &rect) override;
+
+private:
+    FrameProfiler *profiler;
+
+    void drawOverlay(QPainter *painter);
+};
+
+#endif // PROFILEDVIEW_H
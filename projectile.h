@@ -2,7 +2,6 @@
 #define PROJECTILE_H
 
 #include <QPointF>
-#include <QGraphicsEllipseItem>
 
 class Projectile
 {
@@ -13,6 +12,7 @@ public:
     QPointF getVelocity() const { return velocity; }
     double getMass() const { return mass; }
     double getRadius() const { return radius; }
+    double getGravity() const { return gravity; }
     bool isActive() const { return active; }
 
     void setPosition(const QPointF& pos) { position = pos; }
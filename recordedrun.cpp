@@ -0,0 +1,98 @@
+#include "recordedrun.h"
+#include <QFile>
+#include <QDebug>
+#include <cmath>
+
+RecordedRun::RecordedRun()
+    : boxWidth(800), boxHeight(600), dt(0.01)
+{
+}
+
+bool RecordedRun::loadExport(const QString& filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "No se pudo abrir el archivo:" << filename;
+        return false;
+    }
+
+    obstacles.clear();
+
+    // Muestras en el orden del archivo; se agrupan por paso al final
+    QVector<int> steps;
+    QVector<SimReal> rawX, rawY;
+    QVector<qint32> rawIds;
+    bool inTrajectories = false;
+
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty()) continue;
+
+        if (line.startsWith("#")) {
+            QString text = QString::fromUtf8(line.constData(), line.size());
+            if (text.startsWith("# Dimensiones de la caja:")) {
+                QStringList dims = text.mid(text.indexOf(':') + 1).split('x');
+                if (dims.size() == 2) {
+                    boxWidth = dims[0].trimmed().toDouble();
+                    boxHeight = dims[1].trimmed().toDouble();
+                }
+            } else if (text.startsWith("# Paso de tiempo (dt):")) {
+                dt = text.mid(text.indexOf(':') + 1).trimmed().split(' ')[0].toDouble();
+            } else if (text.startsWith("# Obstáculo ")) {
+                QStringList f = text.mid(text.indexOf(':') + 1).split(',');
+                if (f.size() == 4) {
+                    obstacles.append(QRectF(f[0].trimmed().toDouble(), f[1].trimmed().toDouble(),
+                                            f[2].trimmed().toDouble(), f[3].trimmed().toDouble()));
+                }
+            } else if (text.startsWith("# TRAYECTORIAS")) {
+                inTrajectories = true;
+            } else if (text.startsWith("# COLISIONES")) {
+                break;
+            }
+            continue;
+        }
+
+        if (!inTrajectories) continue;
+
+        QList<QByteArray> f = line.split(',');
+        if (f.size() < 4) continue;
+
+        steps.append(static_cast<int>(std::lround(f[0].toDouble() / dt)));
+        rawIds.append(f[1].toInt());
+        rawX.append(static_cast<SimReal>(f[2].toDouble()));
+        rawY.append(static_cast<SimReal>(f[3].toDouble()));
+    }
+
+    // Ordenamiento por conteo según el paso (estable: conserva el orden de ID)
+    int maxStep = 0;
+    for (int s : steps) maxStep = qMax(maxStep, s);
+
+    QVector<int> counts(maxStep + 2, 0);
+    for (int s : steps) counts[s + 1]++;
+    for (int s = 1; s < counts.size(); ++s) counts[s] += counts[s - 1];
+
+    x.resize(steps.size());
+    y.resize(steps.size());
+    ids.resize(steps.size());
+    QVector<int> cursor = counts;
+    for (int k = 0; k < steps.size(); ++k) {
+        int dst = cursor[steps[k]]++;
+        x[dst] = rawX[k];
+        y[dst] = rawY[k];
+        ids[dst] = rawIds[k];
+    }
+
+    // Solo los pasos con muestras forman cuadros
+    frameOffsets.clear();
+    frameSteps.clear();
+    for (int s = 0; s <= maxStep && !steps.isEmpty(); ++s) {
+        if (counts[s + 1] > counts[s]) {
+            frameOffsets.append(counts[s]);
+            frameSteps.append(s);
+        }
+    }
+    frameOffsets.append(steps.size());
+
+    qDebug() << "Corrida cargada:" << frameCount() << "cuadros," << steps.size() << "muestras";
+    return true;
+}
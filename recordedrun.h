@@ -0,0 +1,47 @@
+#ifndef RECORDEDRUN_H
+#define RECORDEDRUN_H
+
+#include "simreal.h"
+#include <QRectF>
+#include <QString>
+#include <QVector>
+
+// Corrida exportada (simulacion_colisiones.txt) cargada en memoria y
+// agrupada por paso: las muestras de cada cuadro quedan contiguas en
+// arreglos separados para recorrerlas de una pasada.
+class RecordedRun
+{
+public:
+    RecordedRun();
+
+    // Acepta exportaciones en orden de paso o por partícula
+    bool loadExport(const QString& filename);
+
+    double getBoxWidth() const { return boxWidth; }
+    double getBoxHeight() const { return boxHeight; }
+    double getDt() const { return dt; }
+    const QVector<QRectF>& getObstacles() const { return obstacles; }
+
+    int frameCount() const { return frameOffsets.size() - 1; }
+    double frameTime(int frame) const { return frameSteps[frame] * dt; }
+    int frameSize(int frame) const { return frameOffsets[frame + 1] - frameOffsets[frame]; }
+
+    // Punteros a las muestras del cuadro (frameSize elementos)
+    const SimReal* frameX(int frame) const { return x.constData() + frameOffsets[frame]; }
+    const SimReal* frameY(int frame) const { return y.constData() + frameOffsets[frame]; }
+    const qint32* frameIds(int frame) const { return ids.constData() + frameOffsets[frame]; }
+
+private:
+    double boxWidth;
+    double boxHeight;
+    double dt;
+    QVector<QRectF> obstacles;
+
+    QVector<SimReal> x;
+    QVector<SimReal> y;
+    QVector<qint32> ids;
+    QVector<int> frameOffsets;   // frameCount + 1 entradas
+    QVector<int> frameSteps;
+};
+
+#endif // RECORDEDRUN_H
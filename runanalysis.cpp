@@ -0,0 +1,784 @@
+#include "runanalysis.h"
+#include "binaryexport.h"
+#include "simulator.h"
+#include "workerpool.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+#include <QDebug>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+QString optionValue(const QStringList& args, const QString& name, const QString& fallback)
+{
+    for (int i = 0; i + 1 < args.size(); ++i) {
+        if (args[i] == name) return args[i + 1];
+    }
+    return fallback;
+}
+
+// Contadores por intervalo de la línea de tiempo: uno por CollisionKind
+const int kinds = RunStatistics::kindCount;
+
+struct AnalysisOptions
+{
+    int threads;
+    int speedBins;
+    double maxSpeed;       // el último bin del histograma es abierto
+    int gridCols;
+    int gridRows;
+    double bucket;         // segundos por intervalo de la línea de tiempo
+    int lineageTrees;
+};
+
+// Fusión del registro de eventos (lo único que se guarda por evento)
+struct MergeRecord
+{
+    double time;
+    qint32 first;
+    qint32 second;
+    qint32 merged;
+    double mass;
+};
+
+// Primera muestra de una partícula en un rango: su anterior está en otro
+struct FirstSample
+{
+    qint32 id;
+    qint32 step;
+    double x;
+    double y;
+};
+
+// Parciales de un hilo sobre su rango contiguo del archivo
+struct AnalysisPartial
+{
+    QVector<qint32> lastStep;     // por ID; -1 = aún no vista en el rango
+    QVector<double> lastX;
+    QVector<double> lastY;
+    QVector<FirstSample> firstSeen;
+
+    QVector<qint64> speedCount;   // por ID
+    QVector<double> speedSum;
+    QVector<double> speedPeak;
+    QVector<qint64> histogram;
+    QVector<qint64> density;
+    QVector<qint64> timeline;     // kinds contadores (CollisionKind) por intervalo
+    QVector<MergeRecord> merges;
+
+    qint64 samples;
+    qint64 events;
+    qint64 skipped;               // líneas o IDs que no se pudieron usar
+};
+
+// Búsqueda de un texto en [from, to) del archivo mapeado
+qint64 findText(const char* data, qint64 from, qint64 to, const char* text)
+{
+    const qint64 length = static_cast<qint64>(std::strlen(text));
+    const char* p = data + from;
+    const char* end = data + to - length + 1;
+    while (p < end) {
+        p = static_cast<const char*>(std::memchr(p, text[0], end - p));
+        if (!p) return -1;
+        if (std::memcmp(p, text, length) == 0) return p - data;
+        ++p;
+    }
+    return -1;
+}
+
+// Número que sigue a 'token' dentro de la línea, a partir de 'from'
+bool numberAfter(const char* line, int length, const char* token, int& from, double& value)
+{
+    qint64 at = findText(line, from, length, token);
+    if (at < 0) return false;
+    int begin = static_cast<int>(at + std::strlen(token));
+    int end = begin;
+    while (end < length && (std::isdigit(static_cast<unsigned char>(line[end]))
+                            || line[end] == '.' || line[end] == '-' || line[end] == 'e'
+                            || line[end] == '+')) {
+        ++end;
+    }
+    bool ok = false;
+    value = QByteArray::fromRawData(line + begin, end - begin).toDouble(&ok);
+    from = end;
+    return ok;
+}
+
+class RunAnalyzer
+{
+public:
+    explicit RunAnalyzer(const AnalysisOptions& options)
+        : options(options), base(nullptr), bytes(0), binary(nullptr),
+          boxWidth(800), boxHeight(600), dt(0.01), runLength(0), initialCount(0), idCount(0),
+          trajBegin(0), trajEnd(0), eventBegin(0), eventEnd(0)
+    {
+    }
+
+    ~RunAnalyzer()
+    {
+        if (base) file.unmap(const_cast<uchar*>(base));
+    }
+
+    bool open(const QString& filename)
+    {
+        file.setFileName(filename);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "No se pudo abrir el archivo:" << filename;
+            return false;
+        }
+        bytes = file.size();
+        base = bytes > 0 ? file.map(0, bytes) : nullptr;
+        if (!base) {
+            qWarning() << "No se pudo mapear el archivo:" << filename;
+            return false;
+        }
+
+        if (bytes >= qint64(sizeof(BinaryRunHeader))
+            && reinterpret_cast<const BinaryRunHeader*>(base)->magic == binaryRunMagic) {
+            return openBinary(filename);
+        }
+        return openText(filename);
+    }
+
+    void run()
+    {
+        WorkerPool pool(options.threads);
+        const int ranges = pool.size();
+        partials.resize(ranges);
+
+        // Eventos primero: las fusiones fijan cuántos IDs hay
+        pool.run([&](int k) {
+            AnalysisPartial& p = partials[k];
+            p.samples = p.events = p.skipped = 0;
+            if (binary) scanBinaryEvents(k, ranges, p);
+            else scanTextEvents(k, ranges, p);
+        });
+
+        // Cada fusión crea un ID: los válidos están por debajo de las
+        // partículas iniciales más las fusiones (un ID dañado no dimensiona
+        // las columnas por ID)
+        qint64 idLimit = initialCount;
+        for (const AnalysisPartial& p : partials) idLimit += p.merges.size();
+        idCount = initialCount;
+        for (AnalysisPartial& p : partials) {
+            int kept = 0;
+            for (const MergeRecord& m : p.merges) {
+                if (m.first < 0 || m.second < 0 || m.merged < 0 || m.first >= idLimit
+                    || m.second >= idLimit || m.merged >= idLimit) {
+                    p.skipped++;
+                    continue;
+                }
+                idCount = qMax(idCount, m.merged + 1);
+                p.merges[kept++] = m;
+            }
+            p.merges.resize(kept);
+        }
+
+        pool.run([&](int k) {
+            AnalysisPartial& p = partials[k];
+            p.lastStep.fill(-1, idCount);
+            p.lastX.fill(0.0, idCount);
+            p.lastY.fill(0.0, idCount);
+            p.speedCount.fill(0, idCount);
+            p.speedSum.fill(0.0, idCount);
+            p.speedPeak.fill(0.0, idCount);
+            p.histogram.fill(0, options.speedBins);
+            p.density.fill(0, options.gridCols * options.gridRows);
+            if (binary) scanBinarySamples(k, ranges, p);
+            else scanTextSamples(k, ranges, p);
+        });
+
+        combine();
+    }
+
+    bool writeReports(const QString& prefix) const
+    {
+        return writeSpeeds(prefix + "_velocidades.csv")
+               && writeParticles(prefix + "_particulas.csv")
+               && writeDensity(prefix + "_densidad.csv")
+               && writeTimeline(prefix + "_colisiones.csv")
+               && writeLineage(prefix + "_linaje.csv", prefix + "_linaje.txt");
+    }
+
+    const char* formatName() const { return binary ? "binario" : "texto"; }
+    qint64 fileBytes() const { return bytes; }
+    qint64 sampleCount() const { return total().samples; }
+    qint64 eventCount() const { return total().events; }
+    qint64 skippedCount() const { return total().skipped; }
+    int mergeCount() const { return total().merges.size(); }
+    int particleIds() const { return idCount; }
+
+private:
+    AnalysisOptions options;
+    QFile file;
+    const uchar* base;
+    qint64 bytes;
+    const BinaryRunHeader* binary;
+
+    double boxWidth;
+    double boxHeight;
+    double dt;
+    double runLength;      // tiempo de la última muestra (-1 = sin trayectorias)
+    int initialCount;
+    int idCount;
+
+    // Secciones de la exportación de texto (desplazamientos en bytes)
+    qint64 trajBegin, trajEnd;
+    qint64 eventBegin, eventEnd;
+
+    QVector<AnalysisPartial> partials;   // tras combine(), el total es partials[0]
+
+    const AnalysisPartial& total() const { return partials[0]; }
+    const char* text() const { return reinterpret_cast<const char*>(base); }
+
+    bool openBinary(const QString& filename)
+    {
+        const BinaryRunHeader* h = reinterpret_cast<const BinaryRunHeader*>(base);
+        if (h->version != binaryRunVersion || h->realSize != sizeof(SimReal)
+            || h->sampleBytes != sizeof(TrajectorySample) || h->eventBytes != sizeof(CollisionEvent)
+            || h->fileBytes != quint64(bytes)) {
+            qWarning() << "Exportación binaria de otra versión o precisión:" << filename
+                       << "(se esperaba" << simPrecisionName() << ")";
+            return false;
+        }
+
+        // Las secciones se leen directo del mapeo desde los hilos: deben caber
+        // en el archivo, tras el encabezado y sin solaparse (archivo truncado
+        // o editado)
+        const quint64 size = quint64(bytes);
+        auto inside = [&](quint64 offset, quint64 count, quint64 element, size_t align) {
+            return offset >= sizeof(BinaryRunHeader) && offset <= size && offset % align == 0
+                   && count <= (size - offset) / element;
+        };
+        const quint64 samplesEnd = h->samplesOffset + h->sampleCount * sizeof(TrajectorySample);
+        const quint64 eventsEnd = h->eventsOffset + h->eventCount * sizeof(CollisionEvent);
+        if (!inside(h->samplesOffset, h->sampleCount, sizeof(TrajectorySample), alignof(TrajectorySample))
+            || !inside(h->eventsOffset, h->eventCount, sizeof(CollisionEvent), alignof(CollisionEvent))
+            || (h->sampleCount > 0 && h->eventCount > 0
+                && h->samplesOffset < eventsEnd && h->eventsOffset < samplesEnd)) {
+            qWarning() << "Exportación binaria dañada (secciones fuera del archivo):" << filename;
+            return false;
+        }
+        binary = h;
+        boxWidth = h->boxWidth;
+        boxHeight = h->boxHeight;
+        dt = h->dt;
+        initialCount = h->initialParticles;
+
+        // Las muestras van en orden de paso
+        const TrajectorySample* samples =
+            reinterpret_cast<const TrajectorySample*>(base + h->samplesOffset);
+        setRunLength(h->sampleCount > 0 ? samples[h->sampleCount - 1].step * dt : 0.0,
+                     static_cast<qint64>(h->sampleCount), filename);
+        return true;
+    }
+
+    bool openText(const QString& filename)
+    {
+        trajBegin = findText(text(), 0, bytes, "# TRAYECTORIAS\n");
+        if (trajBegin < 0) {
+            qWarning() << "El archivo no es una exportación de la simulación:" << filename;
+            return false;
+        }
+
+        // Encabezado: solo las líneas antes de las trayectorias
+        QByteArray head = QByteArray::fromRawData(text(), static_cast<int>(trajBegin));
+        QString header = QString::fromUtf8(head.constData(), head.size());
+        for (const QString& line : header.split('\n')) {
+            QString value = line.mid(line.indexOf(':') + 1).trimmed();
+            if (line.startsWith("# Dimensiones de la caja:")) {
+                QStringList dims = value.split('x');
+                if (dims.size() == 2) {
+                    boxWidth = dims[0].trimmed().toDouble();
+                    boxHeight = dims[1].trimmed().toDouble();
+                }
+            } else if (line.startsWith("# Paso de tiempo (dt):")) {
+                dt = value.split(' ')[0].toDouble();
+            } else if (line.startsWith("# Número de partículas iniciales:")) {
+                initialCount = value.toInt();
+            }
+        }
+
+        trajEnd = findText(text(), trajBegin, bytes, "\n# COLISIONES\n");
+        if (trajEnd < 0) trajEnd = bytes;
+        eventBegin = qMin(bytes, trajEnd + 1);
+        eventEnd = findText(text(), eventBegin, bytes, "\n# RESUMEN\n");
+        if (eventEnd < 0) eventEnd = bytes;
+
+        // Tiempo de la última línea de trayectoria; cada una ocupa al menos
+        // "t,i,x,y\n" (8 bytes)
+        double lastTime = 0.0;
+        qint64 end = trajEnd;
+        while (end > trajBegin) {
+            qint64 start = end;
+            while (start > trajBegin && text()[start - 1] != '\n') --start;
+            if (end > start && text()[start] != '#') {
+                const void* comma = std::memchr(text() + start, ',', end - start);
+                if (comma) {
+                    int length = static_cast<int>(static_cast<const char*>(comma) - (text() + start));
+                    lastTime = QByteArray::fromRawData(text() + start, length).toDouble();
+                }
+                break;
+            }
+            end = start - 1;
+        }
+        setRunLength(lastTime, (trajEnd - trajBegin) / 8, filename);
+        return true;
+    }
+
+    // Duración de la corrida para acotar los tiempos de los eventos: la de la
+    // última muestra, y a lo más un paso por muestra (un tiempo dañado no
+    // dimensiona la línea de tiempo)
+    void setRunLength(double lastTime, qint64 samples, const QString& filename)
+    {
+        runLength = (lastTime >= 0.0) ? qMin(lastTime, samples * dt) : 0.0;
+        if (samples == 0) {
+            runLength = -1.0;
+            qWarning() << "Exportación sin trayectorias: no se conoce la duración de la corrida"
+                       << "y los eventos se omiten:" << filename;
+        }
+    }
+
+    // Tiempo de evento dentro de la corrida (el último paso puede registrar
+    // el evento antes que la muestra)
+    bool inRun(double time) const
+    {
+        return runLength >= 0.0 && time >= 0.0 && time <= runLength + dt;
+    }
+
+    // Rango k de n de la sección [begin, end), alineado a inicios de línea
+    void lineRange(qint64 begin, qint64 end, int k, int n, qint64& from, qint64& to) const
+    {
+        auto align = [&](qint64 pos) {
+            if (pos <= begin) return begin;
+            if (pos >= end) return end;
+            const void* nl = std::memchr(text() + pos - 1, '\n', end - pos + 1);
+            return nl ? static_cast<const char*>(nl) - text() + 1 : end;
+        };
+        from = align(begin + (end - begin) * k / n);
+        to = align(begin + (end - begin) * (k + 1) / n);
+    }
+
+    template <typename F>
+    void forEachLine(qint64 from, qint64 to, F f) const
+    {
+        const char* p = text() + from;
+        const char* end = text() + to;
+        while (p < end) {
+            const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            const char* lineEnd = nl ? nl : end;
+            if (lineEnd > p && *p != '#') f(p, static_cast<int>(lineEnd - p));
+            p = lineEnd + 1;
+        }
+    }
+
+    void scanTextSamples(int k, int n, AnalysisPartial& p)
+    {
+        qint64 from, to;
+        lineRange(trajBegin, trajEnd, k, n, from, to);
+        forEachLine(from, to, [&](const char* line, int length) {
+            // Tiempo, ID, X, Y
+            const char* field[4];
+            int size[4];
+            int count = 0;
+            int start = 0;
+            for (int i = 0; i <= length && count < 4; ++i) {
+                if (i == length || line[i] == ',') {
+                    field[count] = line + start;
+                    size[count] = i - start;
+                    count++;
+                    start = i + 1;
+                }
+            }
+            if (count < 4) {
+                p.skipped++;
+                return;
+            }
+            double time = QByteArray::fromRawData(field[0], size[0]).toDouble();
+            int id = QByteArray::fromRawData(field[1], size[1]).toInt();
+            double x = QByteArray::fromRawData(field[2], size[2]).toDouble();
+            double y = QByteArray::fromRawData(field[3], size[3]).toDouble();
+            addSample(p, static_cast<int>(std::lround(time / dt)), id, x, y);
+        });
+    }
+
+    void scanBinarySamples(int k, int n, AnalysisPartial& p)
+    {
+        const TrajectorySample* samples =
+            reinterpret_cast<const TrajectorySample*>(base + binary->samplesOffset);
+        qint64 count = static_cast<qint64>(binary->sampleCount);
+        for (qint64 i = count * k / n; i < count * (k + 1) / n; ++i) {
+            addSample(p, samples[i].step, samples[i].particleId, samples[i].x, samples[i].y);
+        }
+    }
+
+    void scanTextEvents(int k, int n, AnalysisPartial& p)
+    {
+        qint64 from, to;
+        lineRange(eventBegin, eventEnd, k, n, from, to);
+        forEachLine(from, to, [&](const char* line, int length) {
+            const char* comma = static_cast<const char*>(std::memchr(line, ',', length));
+            if (!comma) {
+                p.skipped++;
+                return;
+            }
+            double time = QByteArray::fromRawData(line, static_cast<int>(comma - line)).toDouble();
+            if (!inRun(time)) {
+                p.skipped++;
+                return;
+            }
+
+            if (findText(line, 0, length, " se fusionan ") < 0) {
+                if (findText(line, 0, length, " chocan ") >= 0) {
+                    addEvent(p, time, ElasticCollision);
+                } else {
+                    bool obstacle = findText(line, 0, length, " obstáculo ") >= 0;
+                    addEvent(p, time, obstacle ? ObstacleCollision : WallCollision);
+                }
+                return;
+            }
+
+            // Partícula A (masa=..) y Partícula B (masa=..) se fusionan en nueva partícula M (masa=..)
+            double a, b, merged, mass, ignored;
+            int at = 0;
+            if (!numberAfter(line, length, "rtícula ", at, a) || !numberAfter(line, length, "masa=", at, ignored)
+                || !numberAfter(line, length, "rtícula ", at, b) || !numberAfter(line, length, "masa=", at, ignored)
+                || !numberAfter(line, length, "rtícula ", at, merged) || !numberAfter(line, length, "masa=", at, mass)) {
+                p.skipped++;
+                return;
+            }
+            MergeRecord record = { time, qint32(a), qint32(b), qint32(merged), mass };
+            p.merges.append(record);
+            addEvent(p, time, MergeCollision);
+        });
+    }
+
+    void scanBinaryEvents(int k, int n, AnalysisPartial& p)
+    {
+        const CollisionEvent* events = reinterpret_cast<const CollisionEvent*>(base + binary->eventsOffset);
+        qint64 count = static_cast<qint64>(binary->eventCount);
+        for (qint64 i = count * k / n; i < count * (k + 1) / n; ++i) {
+            const CollisionEvent& e = events[i];
+            if (!inRun(e.time)) {
+                p.skipped++;
+                continue;
+            }
+            if (e.kind == MergeCollision) {
+                MergeRecord record = { e.time, e.particleA, e.other, e.merged, double(e.mergedMass) };
+                p.merges.append(record);
+            }
+            addEvent(p, e.time, e.kind);
+        }
+    }
+
+    void addEvent(AnalysisPartial& p, double time, int kind)
+    {
+        // Por paso: el tiempo del texto (6 cifras) y el binario caen en el mismo intervalo
+        double stepTime = std::lround(time / dt) * dt;
+        int bucket = qMax(0, static_cast<int>(stepTime / options.bucket + 1e-9));
+        if (p.timeline.size() < kinds * (bucket + 1)) p.timeline.resize(kinds * (bucket + 1));
+        p.timeline[kinds * bucket + qBound(0, kind, kinds - 1)]++;
+        p.events++;
+    }
+
+    void addSpeed(AnalysisPartial& p, int id, double speed)
+    {
+        p.speedCount[id]++;
+        p.speedSum[id] += speed;
+        p.speedPeak[id] = qMax(p.speedPeak[id], speed);
+        p.histogram[speedBin(speed)]++;
+    }
+
+    int speedBin(double speed) const
+    {
+        int bin = static_cast<int>(speed * options.speedBins / options.maxSpeed);
+        return qBound(0, bin, options.speedBins - 1);
+    }
+
+    void addSample(AnalysisPartial& p, int step, int id, double x, double y)
+    {
+        p.samples++;
+        if (id < 0 || id >= idCount) {
+            p.skipped++;
+            return;
+        }
+
+        int cx = qBound(0, static_cast<int>(x * options.gridCols / boxWidth), options.gridCols - 1);
+        int cy = qBound(0, static_cast<int>(y * options.gridRows / boxHeight), options.gridRows - 1);
+        p.density[cy * options.gridCols + cx]++;
+
+        int last = p.lastStep[id];
+        if (last < 0) {
+            FirstSample first = { id, step, x, y };
+            p.firstSeen.append(first);
+        } else if (step > last) {
+            addSpeed(p, id, std::hypot(x - p.lastX[id], y - p.lastY[id]) / ((step - last) * dt));
+        }
+        p.lastStep[id] = step;
+        p.lastX[id] = x;
+        p.lastY[id] = y;
+    }
+
+    // Suma los parciales en partials[0], en orden de rango, y une la rapidez
+    // entre la última muestra de un rango y la primera del siguiente
+    void combine()
+    {
+        AnalysisPartial& sum = partials[0];
+        for (int k = 1; k < partials.size(); ++k) {
+            AnalysisPartial& p = partials[k];
+
+            for (const FirstSample& f : p.firstSeen) {
+                int last = sum.lastStep[f.id];
+                if (last >= 0 && f.step > last) {
+                    addSpeed(sum, f.id, std::hypot(f.x - sum.lastX[f.id], f.y - sum.lastY[f.id])
+                                            / ((f.step - last) * dt));
+                }
+            }
+            for (const FirstSample& f : p.firstSeen) {
+                sum.lastStep[f.id] = p.lastStep[f.id];
+                sum.lastX[f.id] = p.lastX[f.id];
+                sum.lastY[f.id] = p.lastY[f.id];
+            }
+
+            for (int id = 0; id < idCount; ++id) {
+                sum.speedCount[id] += p.speedCount[id];
+                sum.speedSum[id] += p.speedSum[id];
+                sum.speedPeak[id] = qMax(sum.speedPeak[id], p.speedPeak[id]);
+            }
+            for (int b = 0; b < sum.histogram.size(); ++b) sum.histogram[b] += p.histogram[b];
+            for (int c = 0; c < sum.density.size(); ++c) sum.density[c] += p.density[c];
+            if (sum.timeline.size() < p.timeline.size()) sum.timeline.resize(p.timeline.size());
+            for (int t = 0; t < p.timeline.size(); ++t) sum.timeline[t] += p.timeline[t];
+            sum.merges += p.merges;
+            sum.samples += p.samples;
+            sum.events += p.events;
+            sum.skipped += p.skipped;
+
+            p = AnalysisPartial();
+        }
+    }
+
+    bool openReport(QFile& out, const QString& filename) const
+    {
+        out.setFileName(filename);
+        if (!out.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            qWarning() << "No se pudo abrir el archivo para escritura:" << filename;
+            return false;
+        }
+        return true;
+    }
+
+    bool writeSpeeds(const QString& filename) const
+    {
+        QFile file(filename);
+        if (!openReport(file, filename)) return false;
+        QTextStream out(&file);
+
+        QVector<qint64> means(options.speedBins, 0);
+        for (int id = 0; id < idCount; ++id) {
+            if (total().speedCount[id] > 0) {
+                means[speedBin(total().speedSum[id] / total().speedCount[id])]++;
+            }
+        }
+
+        double width = options.maxSpeed / options.speedBins;
+        out << "# Histograma de rapidez (muestras consecutivas de cada partícula); el último bin es abierto\n";
+        out << "# Formato: Desde, Hasta, Muestras, Partículas_por_rapidez_media\n";
+        for (int b = 0; b < options.speedBins; ++b) {
+            out << b * width << ",";
+            if (b + 1 < options.speedBins) out << (b + 1) * width;
+            out << "," << total().histogram[b] << "," << means[b] << "\n";
+        }
+        return true;
+    }
+
+    bool writeParticles(const QString& filename) const
+    {
+        QFile file(filename);
+        if (!openReport(file, filename)) return false;
+        QTextStream out(&file);
+
+        out << "# Rapidez por partícula\n";
+        out << "# Formato: ID, Velocidades_medidas, Rapidez_media, Rapidez_máxima\n";
+        for (int id = 0; id < idCount; ++id) {
+            qint64 n = total().speedCount[id];
+            if (n == 0) continue;
+            out << id << "," << n << "," << total().speedSum[id] / n << "," << total().speedPeak[id] << "\n";
+        }
+        return true;
+    }
+
+    bool writeDensity(const QString& filename) const
+    {
+        QFile file(filename);
+        if (!openReport(file, filename)) return false;
+        QTextStream out(&file);
+
+        out << "# Mapa de densidad: " << options.gridCols << " x " << options.gridRows
+            << " celdas de " << boxWidth / options.gridCols << " x " << boxHeight / options.gridRows
+            << " sobre la caja " << boxWidth << " x " << boxHeight << "\n";
+        out << "# Formato: una fila por fila de celdas (y creciente), muestras por celda\n";
+        for (int row = 0; row < options.gridRows; ++row) {
+            for (int col = 0; col < options.gridCols; ++col) {
+                if (col > 0) out << ",";
+                out << total().density[row * options.gridCols + col];
+            }
+            out << "\n";
+        }
+        return true;
+    }
+
+    bool writeTimeline(const QString& filename) const
+    {
+        QFile file(filename);
+        if (!openReport(file, filename)) return false;
+        QTextStream out(&file);
+
+        out << "# Línea de tiempo de colisiones, intervalos de " << options.bucket << " s\n";
+        out << "# Formato: Desde(s), Paredes, Obstáculos, Fusiones, Elásticos\n";
+        const QVector<qint64>& t = total().timeline;
+        for (int b = 0; kinds * b < t.size(); ++b) {
+            out << b * options.bucket << "," << t[kinds * b + WallCollision] << ","
+                << t[kinds * b + ObstacleCollision] << "," << t[kinds * b + MergeCollision] << ","
+                << t[kinds * b + ElasticCollision] << "\n";
+        }
+        return true;
+    }
+
+    bool writeLineage(const QString& csvName, const QString& treeName) const
+    {
+        const QVector<MergeRecord>& merges = total().merges;
+        const int n = merges.size();
+
+        // Los registros van en orden de tiempo: los padres se procesan antes
+        QHash<qint32, int> recordOf;      // ID fusionado -> registro
+        QHash<qint32, qint32> childOf;    // padre -> ID fusionado
+        QVector<int> depth(n);
+        QVector<int> leaves(n);
+        recordOf.reserve(n);
+        childOf.reserve(2 * n);
+        for (int i = 0; i < n; ++i) {
+            const MergeRecord& m = merges[i];
+            int ra = recordOf.value(m.first, -1);
+            int rb = recordOf.value(m.second, -1);
+            depth[i] = 1 + qMax(ra >= 0 ? depth[ra] : 0, rb >= 0 ? depth[rb] : 0);
+            leaves[i] = (ra >= 0 ? leaves[ra] : 1) + (rb >= 0 ? leaves[rb] : 1);
+            recordOf.insert(m.merged, i);
+            childOf.insert(m.first, m.merged);
+            childOf.insert(m.second, m.merged);
+        }
+
+        // Descendiente final: de la fusión más reciente hacia atrás
+        QVector<qint32> root(n);
+        QVector<int> roots;
+        for (int i = n - 1; i >= 0; --i) {
+            qint32 child = childOf.value(merges[i].merged, -1);
+            root[i] = (child >= 0) ? root[recordOf.value(child)] : merges[i].merged;
+            if (child < 0) roots.append(i);
+        }
+
+        QFile csv(csvName);
+        if (!openReport(csv, csvName)) return false;
+        QTextStream out(&csv);
+        out << "# Linaje de fusiones: " << n << " fusiones, " << roots.size() << " árboles\n";
+        out << "# Formato: Partícula, Tiempo(s), Padre_A, Padre_B, Masa, Profundidad, Originales, Descendiente_final\n";
+        for (int i = 0; i < n; ++i) {
+            const MergeRecord& m = merges[i];
+            out << m.merged << "," << m.time << "," << m.first << "," << m.second << "," << m.mass
+                << "," << depth[i] << "," << leaves[i] << "," << root[i] << "\n";
+        }
+
+        // Árboles más grandes, recorridos con pila explícita (las cadenas
+        // de fusiones pueden ser muy profundas)
+        std::sort(roots.begin(), roots.end(), [&](int a, int b) {
+            return leaves[a] != leaves[b] ? leaves[a] > leaves[b] : a < b;
+        });
+
+        QFile tree(treeName);
+        if (!openReport(tree, treeName)) return false;
+        QTextStream treeOut(&tree);
+        treeOut << "# Árboles de fusión más grandes (" << qMin(options.lineageTrees, roots.size())
+                << " de " << roots.size() << ")\n";
+        for (int r = 0; r < qMin(options.lineageTrees, roots.size()); ++r) {
+            QVector<QPair<qint32, int>> stack;   // (ID, nivel)
+            stack.append(qMakePair(merges[roots[r]].merged, 0));
+            while (!stack.isEmpty()) {
+                QPair<qint32, int> top = stack.takeLast();
+                treeOut << QString(2 * top.second, ' ') << "Partícula " << top.first;
+                int i = recordOf.value(top.first, -1);
+                if (i < 0) {
+                    treeOut << "\n";
+                    continue;
+                }
+                const MergeRecord& m = merges[i];
+                treeOut << " (masa=" << m.mass << ", t=" << m.time << ", originales="
+                        << leaves[i] << ")\n";
+                stack.append(qMakePair(m.second, top.second + 1));
+                stack.append(qMakePair(m.first, top.second + 1));
+            }
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+int runAnalysis(const QStringList& args)
+{
+    int index = args.indexOf("--analyze");
+    if (index < 0 || index + 1 >= args.size()) {
+        qWarning() << "Uso: practica5 --analyze archivo [--threads H] [--out prefijo]";
+        return 1;
+    }
+
+    AnalysisOptions options;
+    options.threads = qMax(1, optionValue(args, "--threads",
+                                          QString::number(QThread::idealThreadCount())).toInt());
+    options.speedBins = qMax(1, optionValue(args, "--speed-bins", "32").toInt());
+    options.maxSpeed = optionValue(args, "--max-speed", "200").toDouble();
+    options.bucket = optionValue(args, "--bucket", "0.1").toDouble();
+    options.lineageTrees = qMax(0, optionValue(args, "--lineage-trees", "5").toInt());
+    QStringList grid = optionValue(args, "--grid", "80x60").split('x');
+    options.gridCols = qMax(1, grid[0].toInt());
+    options.gridRows = qMax(1, grid.size() > 1 ? grid[1].toInt() : options.gridCols);
+    if (!(options.maxSpeed > 0) || !(options.bucket > 0)) {
+        qWarning() << "--max-speed y --bucket deben ser positivos";
+        return 1;
+    }
+
+    RunAnalyzer analyzer(options);
+    if (!analyzer.open(args[index + 1])) {
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    analyzer.run();
+    qint64 elapsedNs = timer.nsecsElapsed();
+
+    if (!analyzer.writeReports(optionValue(args, "--out", "analisis"))) {
+        return 1;
+    }
+
+    double seconds = elapsedNs / 1.0e9;
+    QTextStream out(stdout);
+    out << "format=" << analyzer.formatName()
+        << " threads=" << options.threads
+        << " bytes=" << analyzer.fileBytes()
+        << " samples=" << analyzer.sampleCount()
+        << " events=" << analyzer.eventCount()
+        << " merges=" << analyzer.mergeCount()
+        << " particle_ids=" << analyzer.particleIds()
+        << " skipped=" << analyzer.skippedCount()
+        << " analysis_ms=" << seconds * 1000.0
+        << " mb_per_s=" << (seconds > 0 ? analyzer.fileBytes() / seconds / (1024.0 * 1024.0) : 0.0)
+        << "\n";
+    return 0;
+}
@@ -0,0 +1,37 @@
+#ifndef RUNANALYSIS_H
+#define RUNANALYSIS_H
+
+#include <QString>
+#include <QStringList>
+
+// Análisis fuera de línea de corridas exportadas, sin Python:
+//
+//   practica5 --analyze archivo [--threads H] [--out prefijo]
+//                       [--speed-bins N] [--max-speed V] [--grid CxF]
+//                       [--bucket S] [--lineage-trees K]
+//
+// Acepta la exportación de texto (simulacion_colisiones.txt, también la
+// combinada de --tiles) y la binaria de Simulator::exportBinary; el formato
+// se reconoce por el número mágico. El archivo se mapea en memoria y cada
+// hilo recorre un rango contiguo de trayectorias y de eventos acumulando
+// parciales; nada del archivo se copia a memoria propia salvo las fusiones.
+//
+// Escribe, con encabezados "# ...":
+//   prefijo_velocidades.csv   histograma de rapidez de todas las muestras
+//                             (el último bin es abierto) y el de la rapidez
+//                             media por partícula
+//   prefijo_particulas.csv    por partícula: muestras, rapidez media y máxima
+//   prefijo_densidad.csv      mapa de calor: muestras por celda (C x F)
+//   prefijo_colisiones.csv    línea de tiempo: eventos por tipo cada S segundos
+//   prefijo_linaje.csv        cada fusión con sus padres, profundidad,
+//                             partículas originales y descendiente final
+//   prefijo_linaje.txt        los K árboles de fusión más grandes, indentados
+//
+// La rapidez sale de muestras consecutivas de la misma partícula; las que
+// caen en el borde entre dos rangos se unen al final en orden de rango.
+// Se omiten (y cuentan en skipped) los eventos con tiempo fuera de la
+// corrida (hasta la última muestra de trayectoria) y las fusiones con IDs
+// fuera de partículas iniciales + fusiones.
+int runAnalysis(const QStringList& args);
+
+#endif // RUNANALYSIS_H
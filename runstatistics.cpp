@@ -0,0 +1,153 @@
+#include "runstatistics.h"
+#include <QDebug>
+#include <cmath>
+
+RunStatistics::RunStatistics()
+    : interval(1), step(), current(), mergeLoss(0.0), restitutionLoss(0.0), totalPath(0.0),
+    intervalTime(0.0), massHistogram(massBins, 0),
+    mergedMassMin(0.0), mergedMassMax(0.0), mergedMassSum(0.0)
+{
+    for (int k = 0; k < kindCount; ++k) {
+        kindTotals[k] = 0;
+        intervalStart[k] = 0;
+    }
+}
+
+bool RunStatistics::setSeriesFile(const QString& filename, int everySteps)
+{
+    setInterval(everySteps);
+
+    if (seriesFile.isOpen()) {
+        seriesOut.flush();
+        seriesFile.close();
+    }
+    if (filename.isEmpty()) return true;
+
+    seriesFile.setFileName(filename);
+    if (!seriesFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "No se pudo abrir el archivo de estadísticas:" << filename;
+        return false;
+    }
+
+    seriesOut.setDevice(&seriesFile);
+    seriesOut << "# Estadísticas de la corrida cada " << interval << " pasos\n";
+    seriesOut << "# Formato: Paso, Tiempo(s), Activas, Px, Py, Energía_cinética, "
+                 "Pérdida_fusiones, Pérdida_restitución, Recorrido_libre_medio, "
+                 "Tasa_paredes(1/s), Tasa_obstáculos(1/s), Tasa_fusiones(1/s), "
+                 "Tasa_elásticos(1/s)\n";
+    return true;
+}
+
+void RunStatistics::addTally(const StepTally& tally)
+{
+    step.momentumX += tally.momentumX;
+    step.momentumY += tally.momentumY;
+    step.kinetic += tally.kinetic;
+    step.path += tally.path;
+    step.restitutionLoss += tally.restitutionLoss;
+    step.active += tally.active;
+}
+
+void RunStatistics::countEvent(qint32 kind)
+{
+    kindTotals[kind]++;
+}
+
+void RunStatistics::addMerge(const Particle& a, const Particle& b, const Particle& merged)
+{
+    // Las sumas del paso se tomaron antes de la fusión: se corrigen aquí
+    auto kinetic = [](const Particle& p) {
+        QPointF v = p.getVelocity();
+        return 0.5 * p.getMass() * (v.x() * v.x() + v.y() * v.y());
+    };
+
+    double before = kinetic(a) + kinetic(b);
+    double after = kinetic(merged);
+    mergeLoss += before - after;
+
+    step.kinetic += after - before;
+    step.active -= 1;
+    step.momentumX += merged.getMass() * merged.getVelocity().x()
+                      - a.getMass() * a.getVelocity().x() - b.getMass() * b.getVelocity().x();
+    step.momentumY += merged.getMass() * merged.getVelocity().y()
+                      - a.getMass() * a.getVelocity().y() - b.getMass() * b.getVelocity().y();
+
+    double m = merged.getMass();
+    int bin = static_cast<int>(std::floor(std::log2(m))) + 4;
+    massHistogram[qBound(0, bin, massBins - 1)]++;
+
+    if (mergedMassSum == 0.0) {
+        mergedMassMin = m;
+        mergedMassMax = m;
+    }
+    mergedMassMin = qMin(mergedMassMin, m);
+    mergedMassMax = qMax(mergedMassMax, m);
+    mergedMassSum += m;
+}
+
+void RunStatistics::endStep(int stepsDone, double elapsedTime)
+{
+    current = step;
+    totalPath += step.path;
+    restitutionLoss += step.restitutionLoss;
+    step = StepTally();
+
+    if (stepsDone % interval != 0) return;
+
+    // Tasas sobre el intervalo desde el renglón anterior
+    double elapsed = elapsedTime - intervalTime;
+    double rates[kindCount];
+    for (int k = 0; k < kindCount; ++k) {
+        rates[k] = elapsed > 0.0 ? (kindTotals[k] - intervalStart[k]) / elapsed : 0.0;
+        intervalStart[k] = kindTotals[k];
+    }
+    intervalTime = elapsedTime;
+
+    StatisticsSample sample = { stepsDone, current.active, elapsedTime,
+                                current.momentumX, current.momentumY, current.kinetic,
+                                mergeLoss, restitutionLoss, meanFreePath(),
+                                rates[0], rates[1], rates[2], rates[3] };
+    samples.append(sample);
+
+    if (seriesFile.isOpen()) {
+        seriesOut << sample.step << "," << sample.time << "," << sample.active << ","
+                  << sample.momentumX << "," << sample.momentumY << "," << sample.kinetic << ","
+                  << sample.mergeLoss << "," << sample.restitutionLoss << ","
+                  << sample.meanFreePath << "," << sample.wallRate << ","
+                  << sample.obstacleRate << "," << sample.mergeRate << ","
+                  << sample.elasticRate << "\n";
+    }
+}
+
+double RunStatistics::meanFreePath() const
+{
+    qint64 hits = kindTotals[0] + kindTotals[1] + 2 * (kindTotals[2] + kindTotals[3]);
+    return hits > 0 ? totalPath / hits : totalPath;
+}
+
+double RunStatistics::massBinLower(int bin)
+{
+    return std::ldexp(1.0, bin - 4);
+}
+
+void RunStatistics::writeSummary(QTextStream& out) const
+{
+    out << "# Momento total final: (" << current.momentumX << ", " << current.momentumY << ")\n";
+    out << "# Energía cinética final: " << current.kinetic << "\n";
+    out << "# Energía perdida en fusiones: " << mergeLoss << "\n";
+    out << "# Energía perdida por restitución: " << restitutionLoss << "\n";
+    out << "# Recorrido libre medio: " << meanFreePath() << "\n";
+
+    qint64 merges = kindTotals[2];
+    if (merges > 0) {
+        out << "# Masa fusionada (mín/media/máx): " << mergedMassMin << " / "
+            << mergedMassSum / merges << " / " << mergedMassMax << "\n";
+        out << "# Histograma de masas fusionadas [desde, cantidad]:";
+        for (int k = 0; k < massBins; ++k) {
+            if (massHistogram[k] > 0) {
+                out << " [" << massBinLower(k) << ", " << massHistogram[k] << "]";
+            }
+        }
+        out << "\n";
+    }
+}
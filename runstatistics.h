@@ -0,0 +1,104 @@
+#ifndef RUNSTATISTICS_H
+#define RUNSTATISTICS_H
+
+#include "particle.h"
+#include <QFile>
+#include <QString>
+#include <QTextStream>
+#include <QVector>
+
+// Sumas parciales de un bloque de partículas en un paso. Las llenan las
+// mismas pasadas que integran y resuelven obstáculos (sin recorrido extra)
+// y se combinan en orden de bloque, así que no dependen del número de hilos.
+struct StepTally {
+    double momentumX;
+    double momentumY;
+    double kinetic;           // energía cinética tras paredes y obstáculos
+    double path;              // distancia recorrida en el paso
+    double restitutionLoss;   // energía disipada contra obstáculos
+    qint32 active;            // partículas activas
+};
+
+// Punto de la serie de tiempo (un renglón cada N pasos)
+struct StatisticsSample {
+    qint32 step;              // pasos completados
+    qint32 active;
+    double time;              // tiempo al final del paso
+    double momentumX;
+    double momentumY;
+    double kinetic;
+    double mergeLoss;         // acumulada desde el inicio
+    double restitutionLoss;   // acumulada desde el inicio
+    double meanFreePath;
+    double wallRate;          // eventos por segundo en el intervalo
+    double obstacleRate;
+    double mergeRate;
+    double elasticRate;       // choques elásticos entre partículas
+};
+
+// Estadísticas físicas acumuladas durante la corrida: momento total,
+// energía perdida en fusiones y por restitución, tasas de colisión por tipo,
+// distribución de masas fusionadas y recorrido libre medio. Permite
+// analizar una corrida sin guardar sus trayectorias.
+class RunStatistics
+{
+public:
+    RunStatistics();
+
+    // Serie de tiempo en CSV cada 'everySteps' pasos (vacío = solo en memoria)
+    bool setSeriesFile(const QString& filename, int everySteps = 1);
+    void setInterval(int everySteps) { interval = qMax(1, everySteps); }
+
+    // Ciclo por paso: sumas de bloque, eventos y fusiones, luego endStep.
+    // 'kind' es un CollisionKind (0 pared, 1 obstáculo, 2 fusión, 3 elástico).
+    void addTally(const StepTally& tally);
+    void countEvent(qint32 kind);
+    void addMerge(const Particle& a, const Particle& b, const Particle& merged);
+    void endStep(int stepsDone, double elapsedTime);
+
+    qint64 eventCount(qint32 kind) const { return kindTotals[kind]; }
+    double getMergeLoss() const { return mergeLoss; }
+    double getRestitutionLoss() const { return restitutionLoss; }
+    double getKineticEnergy() const { return current.kinetic; }
+    QPointF getMomentum() const { return QPointF(current.momentumX, current.momentumY); }
+
+    // Distancia total recorrida entre el número de choques por partícula
+    // (pared y obstáculo cuentan 1, una fusión o un choque elástico cuentan 2)
+    double meanFreePath() const;
+
+    // Histograma de masas fusionadas en potencias de 2: el bin k cubre
+    // [2^(k-4), 2^(k-3)); el primero y el último absorben los extremos
+    static const int massBins = 24;
+    static double massBinLower(int bin);
+    const QVector<qint64>& mergedMassHistogram() const { return massHistogram; }
+
+    const QVector<StatisticsSample>& series() const { return samples; }
+
+    static const int kindCount = 4;
+
+    // Renglones "# ..." para el resumen de exportToFile
+    void writeSummary(QTextStream& out) const;
+
+private:
+    int interval;
+    QFile seriesFile;
+    QTextStream seriesOut;
+
+    StepTally step;        // paso en curso
+    StepTally current;     // último paso completo
+    double mergeLoss;
+    double restitutionLoss;
+    double totalPath;
+    qint64 kindTotals[kindCount];
+    qint64 intervalStart[kindCount];   // totales al inicio del intervalo
+    double intervalTime;
+
+    QVector<qint64> massHistogram;
+    double mergedMassMin;
+    double mergedMassMax;
+    double mergedMassSum;
+
+    QVector<StatisticsSample> samples;
+};
+
+#endif // RUNSTATISTICS_H
@@ -0,0 +1,358 @@
+#include "scenariogenerator.h"
+#include "box.h"
+#include "collisionkernels.h"
+#include "initialconditions.h"
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+QString optionValue(const QStringList& args, const QString& name, const QString& fallback)
+{
+    for (int i = 0; i + 1 < args.size(); ++i) {
+        if (args[i] == name) return args[i + 1];
+    }
+    return fallback;
+}
+
+// Holgura relativa de las pruebas de exclusión: las posiciones se guardan en
+// SimReal y el simulador compara en esa precisión
+const double exclusionSlack = 1e-5;
+
+// Candidatos por punto activo antes de retirarlo (Bridson usa 30)
+const int candidatesPerPoint = 12;
+
+// Dardos por celda vacía al buscar una semilla nueva
+const int dartsPerCell = 8;
+
+// Todas las extracciones salen de la salida cruda de mt19937, que el
+// estándar fija; el algoritmo de las distribuciones de <random> y de
+// std::shuffle depende de la biblioteca, y la misma semilla daría otro
+// escenario en otra plataforma
+
+// Uniforme en [0, 1) con una sola extracción del generador
+double unitDraw(std::mt19937& rng)
+{
+    return rng() * (1.0 / 4294967296.0);
+}
+
+// Entero uniforme en [0, count)
+int indexDraw(std::mt19937& rng, int count)
+{
+    return qMin(count - 1, static_cast<int>(unitDraw(rng) * count));
+}
+
+// Normal estándar por Box-Muller: cada par de uniformes da dos normales y
+// la segunda se guarda para la siguiente llamada
+class NormalDraw
+{
+public:
+    NormalDraw() : hasSpare(false), spare(0.0) {}
+
+    double operator()(std::mt19937& rng)
+    {
+        if (hasSpare) {
+            hasSpare = false;
+            return spare;
+        }
+        // 1 - u está en (0, 1]: el logaritmo es finito
+        const double length = std::sqrt(-2.0 * std::log(1.0 - unitDraw(rng)));
+        const double angle = 2.0 * M_PI * unitDraw(rng);
+        spare = length * std::sin(angle);
+        hasSpare = true;
+        return length * std::cos(angle);
+    }
+
+private:
+    bool hasSpare;
+    double spare;
+};
+
+// Conjunto maximal de disco de Poisson con radios variables: dos centros
+// guardan al menos max(spacing, ri + rj + gap)
+class PoissonDiskSampler
+{
+public:
+    PoissonDiskSampler(const ScenarioSpec& spec, double spacing)
+        : spec(spec), spacing(spacing), box(spec.boxWidth, spec.boxHeight),
+          rng(spec.seed)
+    {
+        for (const QRectF& rect : spec.obstacles) rects.append(rect);
+
+        // La celda cubre la mayor distancia de exclusión: basta con las 8 vecinas
+        cell = std::max(spacing, 2.0 * spec.radiusMax + spec.gap) * (1.0 + exclusionSlack);
+        cols = std::max(1, static_cast<int>(std::ceil(spec.boxWidth / cell)));
+        rows = std::max(1, static_cast<int>(std::ceil(spec.boxHeight / cell)));
+        head.fill(-1, cols * rows);
+    }
+
+    void fill()
+    {
+        // Celdas en orden aleatorio; cada celda vacía intenta sembrar un
+        // punto y el frente de Bridson crece desde él hasta agotarse
+        QVector<int> order(cols * rows);
+        for (int c = 0; c < order.size(); ++c) order[c] = c;
+        for (int k = order.size() - 1; k > 0; --k) {
+            std::swap(order[k], order[indexDraw(rng, k + 1)]);
+        }
+
+        for (int c : order) {
+            if (head[c] >= 0) continue;
+            const double left = (c % cols) * cell;
+            const double top = (c / cols) * cell;
+            for (int t = 0; t < dartsPerCell; ++t) {
+                double r = drawRadius();
+                if (tryInsert(left + unit() * cell, top + unit() * cell, r)) {
+                    grow();
+                    break;
+                }
+            }
+        }
+    }
+
+    int size() const { return x.size(); }
+
+    QVector<SimReal> x, y, radius;
+
+private:
+    const ScenarioSpec& spec;
+    const double spacing;
+    Box box;
+    RectPack<SimReal> rects;
+    std::mt19937 rng;
+
+    double cell;
+    int cols, rows;
+    QVector<qint32> head;   // primer punto de cada celda (-1 = vacía)
+    QVector<qint32> next;   // siguiente punto de la misma celda
+    QVector<qint32> active;
+
+    double unit()
+    {
+        return unitDraw(rng);
+    }
+
+    double drawRadius()
+    {
+        return spec.radiusMin + (spec.radiusMax - spec.radiusMin) * unit();
+    }
+
+    double exclusion(double ri, double rj) const
+    {
+        return std::max(spacing, ri + rj + spec.gap) * (1.0 + exclusionSlack);
+    }
+
+    // Inserta el candidato si no toca paredes, obstáculos ni otros puntos
+    bool tryInsert(double px, double py, double pr)
+    {
+        const SimReal sx = static_cast<SimReal>(px);
+        const SimReal sy = static_cast<SimReal>(py);
+        const SimReal sr = static_cast<SimReal>(pr);
+        const SimReal reach = static_cast<SimReal>(pr * (1.0 + exclusionSlack) + spec.gap);
+        if (box.checkWallCollision(sx, sy, reach) != 0) return false;
+        if (rects.size() > 0 && firstCircleRectHit(sx, sy, reach, rects) >= 0) return false;
+
+        const int cx = qBound(0, static_cast<int>(sx / cell), cols - 1);
+        const int cy = qBound(0, static_cast<int>(sy / cell), rows - 1);
+        for (int gy = qMax(0, cy - 1); gy <= qMin(rows - 1, cy + 1); ++gy) {
+            for (int gx = qMax(0, cx - 1); gx <= qMin(cols - 1, cx + 1); ++gx) {
+                for (int k = head[gy * cols + gx]; k >= 0; k = next[k]) {
+                    double dx = double(sx) - x[k];
+                    double dy = double(sy) - y[k];
+                    double d = exclusion(sr, radius[k]);
+                    if (dx * dx + dy * dy < d * d) return false;
+                }
+            }
+        }
+
+        const int index = x.size();
+        const int c = cy * cols + cx;
+        x.append(sx);
+        y.append(sy);
+        radius.append(sr);
+        next.append(head[c]);
+        head[c] = index;
+        active.append(index);
+        return true;
+    }
+
+    // Frente de Bridson: candidatos en el anillo [d, 2d] de un punto activo
+    // al azar; el punto se retira cuando ninguno cabe. El anillo se muestrea
+    // por rechazo en el cuadrado que lo contiene (uniforme en área, sin
+    // funciones trigonométricas)
+    void grow()
+    {
+        while (!active.isEmpty()) {
+            const int a = static_cast<int>(unit() * active.size());
+            const int p = active[a];
+
+            bool placed = false;
+            for (int t = 0; t < candidatesPerPoint && !placed; ++t) {
+                double r = drawRadius();
+                double d = exclusion(radius[p], r);
+                double dx, dy, d2;
+                do {
+                    dx = (4.0 * unit() - 2.0) * d;
+                    dy = (4.0 * unit() - 2.0) * d;
+                    d2 = dx * dx + dy * dy;
+                } while (d2 < d * d || d2 > 4.0 * d * d);
+                placed = tryInsert(x[p] + dx, y[p] + dy, r);
+            }
+            if (!placed) {
+                active[a] = active.last();
+                active.removeLast();
+            }
+        }
+    }
+};
+
+} // namespace
+
+ScenarioSpec::ScenarioSpec()
+    : particleCount(0), boxWidth(800.0), boxHeight(600.0),
+      radiusMin(2.0), radiusMax(2.0), mass(1.0),
+      velocity(UniformVelocity), speed(50.0), gap(0.0), spacing(0.0), seed(12345)
+{
+}
+
+bool generateScenario(const ScenarioSpec& spec, ParticleStore& out, ScenarioReport* report)
+{
+    const int n = spec.particleCount;
+    if (n < 0 || spec.radiusMin <= 0 || spec.radiusMax < spec.radiusMin || spec.gap < 0) {
+        qWarning() << "Parámetros de escenario inválidos";
+        return false;
+    }
+
+    // Separación automática: el conjunto maximal de Bridson deja cerca de
+    // 0.7 / s² puntos por unidad de área; se apunta a ~1.3 N candidatos
+    double freeArea = spec.boxWidth * spec.boxHeight;
+    for (const QRectF& rect : spec.obstacles) {
+        freeArea -= rect.width() * rect.height();
+    }
+    const double contact = 2.0 * spec.radiusMin + spec.gap;
+    double spacing = spec.spacing > 0 ? spec.spacing
+                                       : std::sqrt(0.54 * std::max(freeArea, 0.0) / qMax(1, n));
+    spacing = std::max(spacing, contact);
+
+    for (int attempt = 1; ; ++attempt) {
+        PoissonDiskSampler sampler(spec, spacing);
+        sampler.fill();
+        const int candidates = sampler.size();
+
+        if (candidates >= n) {
+            // N puntos al azar del conjunto maximal (Fisher-Yates parcial),
+            // en orden de generación para conservar la coherencia espacial
+            std::mt19937 rng(spec.seed ^ 0x5bd1e995u);
+            QVector<int> pick(candidates);
+            for (int k = 0; k < candidates; ++k) pick[k] = k;
+            for (int k = 0; k < n; ++k) {
+                std::swap(pick[k], pick[k + indexDraw(rng, candidates - k)]);
+            }
+            pick.resize(n);
+            std::sort(pick.begin(), pick.end());
+
+            NormalDraw normal;
+            auto component = [&]() {
+                return spec.velocity == GaussianVelocity ? spec.speed * normal(rng)
+                                                         : spec.speed * (2.0 * unitDraw(rng) - 1.0);
+            };
+
+            out.resize(n);
+            for (int k = 0; k < n; ++k) {
+                const int i = pick[k];
+                const double r = sampler.radius[i];
+                out.x[k] = sampler.x[i];
+                out.y[k] = sampler.y[i];
+                out.vx[k] = static_cast<SimReal>(component());
+                out.vy[k] = static_cast<SimReal>(component());
+                out.mass[k] = static_cast<SimReal>(spec.mass * (r * r) / (spec.radiusMax * spec.radiusMax));
+                out.radius[k] = sampler.radius[i];
+                out.active[k] = 1;
+            }
+
+            if (report) {
+                report->candidates = candidates;
+                report->attempts = attempt;
+                report->spacing = spacing;
+            }
+            return true;
+        }
+
+        // No caben: se reduce la separación hasta el contacto entre radios mínimos
+        if (spacing <= contact) {
+            qWarning() << "Solo caben" << candidates << "de" << n << "partículas sin traslapes";
+            return false;
+        }
+        spacing = std::max(contact, spacing * 0.85);
+    }
+}
+
+int runGenerator(const QStringList& args)
+{
+    int index = args.indexOf("--generate");
+    if (index < 0 || index + 1 >= args.size()) {
+        qWarning() << "Uso: practica5 --generate archivo.p5ic [--particles N] [--box AxB]";
+        return 1;
+    }
+    const QString filename = args[index + 1];
+
+    ScenarioSpec spec;
+    spec.particleCount = optionValue(args, "--particles", "100000").toInt();
+    double defaultSide = std::max(200.0, 10.0 * std::ceil(std::sqrt(double(qMax(1, spec.particleCount)))) + 20.0);
+    QStringList box = optionValue(args, "--box", QString()).split('x');
+    spec.boxWidth = box[0].isEmpty() ? defaultSide : box[0].toDouble();
+    spec.boxHeight = box.size() > 1 ? box[1].toDouble() : spec.boxWidth;
+    double radius = optionValue(args, "--radius", "2").toDouble();
+    spec.radiusMin = optionValue(args, "--radius-min", QString::number(radius)).toDouble();
+    spec.radiusMax = optionValue(args, "--radius-max", QString::number(qMax(radius, spec.radiusMin))).toDouble();
+    spec.mass = optionValue(args, "--mass", "1").toDouble();
+    spec.speed = optionValue(args, "--speed", "50").toDouble();
+    spec.velocity = args.contains("--gaussian") ? GaussianVelocity : UniformVelocity;
+    spec.gap = optionValue(args, "--gap", "0").toDouble();
+    spec.spacing = optionValue(args, "--spacing", "0").toDouble();
+    spec.seed = optionValue(args, "--seed", "12345").toUInt();
+
+    // --obstacle x,y,ancho,alto (se puede repetir)
+    for (int i = 0; i + 1 < args.size(); ++i) {
+        if (args[i] != "--obstacle") continue;
+        QStringList r = args[i + 1].split(',');
+        if (r.size() != 4) {
+            qWarning() << "Obstáculo inválido:" << args[i + 1];
+            return 1;
+        }
+        spec.obstacles.append(QRectF(r[0].toDouble(), r[1].toDouble(), r[2].toDouble(), r[3].toDouble()));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    ParticleStore particles;
+    ScenarioReport report = {};
+    if (!generateScenario(spec, particles, &report)) {
+        return 1;
+    }
+    qint64 generateNs = timer.nsecsElapsed();
+
+    timer.restart();
+    if (!writeInitialConditions(filename, spec.boxWidth, spec.boxHeight, particles, QVector<int>(),
+                                spec.obstacles)) {
+        return 1;
+    }
+    qint64 writeNs = timer.nsecsElapsed();
+
+    QTextStream out(stdout);
+    out << "particles=" << particles.size()
+        << " box=" << spec.boxWidth << "x" << spec.boxHeight
+        << " obstacles=" << spec.obstacles.size()
+        << " candidates=" << report.candidates
+        << " attempts=" << report.attempts
+        << " spacing=" << report.spacing
+        << " seed=" << spec.seed
+        << " generate_ms=" << (generateNs / 1.0e6)
+        << " write_ms=" << (writeNs / 1.0e6)
+        << "\n";
+    return 0;
+}
@@ -0,0 +1,67 @@
+#ifndef SCENARIOGENERATOR_H
+#define SCENARIOGENERATOR_H
+
+#include "particlestore.h"
+#include <QRectF>
+#include <QStringList>
+#include <QVector>
+
+// Generador de escenarios grandes sin traslapes:
+//
+//   practica5 --generate archivo.p5ic [--particles N] [--box AxB]
+//                        [--radius R | --radius-min a --radius-max b]
+//                        [--mass M] [--speed V] [--gaussian] [--gap G]
+//                        [--spacing S] [--seed S] [--obstacle x,y,ancho,alto ...]
+//
+// Muestreo de disco de Poisson (Bridson) acelerado con una rejilla de celdas
+// del tamaño de la mayor distancia de exclusión: cada candidato se compara
+// solo con las partículas de su celda y las 8 vecinas. Las semillas salen de
+// las celdas vacías en orden aleatorio, así que también se llenan las zonas
+// que los obstáculos separan del resto. Se genera un conjunto maximal con
+// una separación ajustada a N y se eligen N puntos al azar; si no alcanzan,
+// se reduce la separación y se repite.
+//
+// Ninguna partícula toca una pared, un obstáculo ni a otra partícula con las
+// mismas pruebas (y la misma precisión) que usa el simulador, así que el
+// primer paso no produce fusiones ni rebotes espurios. La misma semilla da
+// el mismo escenario.
+
+enum VelocityDistribution {
+    UniformVelocity,    // cada componente uniforme en [-speed, speed]
+    GaussianVelocity    // cada componente normal con desviación speed
+};
+
+struct ScenarioSpec
+{
+    int particleCount;
+    double boxWidth;
+    double boxHeight;
+    QVector<QRectF> obstacles;
+    double radiusMin;
+    double radiusMax;
+    double mass;            // masa con radiusMax; escala con el área
+    VelocityDistribution velocity;
+    double speed;
+    double gap;             // separación mínima entre superficies
+    double spacing;         // distancia mínima entre centros (0 = según N)
+    unsigned int seed;
+
+    ScenarioSpec();
+};
+
+// Resultado de generateScenario
+struct ScenarioReport
+{
+    int candidates;         // tamaño del conjunto maximal del que se eligió
+    int attempts;           // generaciones (una más por cada reducción)
+    double spacing;         // separación con la que se generó
+};
+
+// Llena 'out' con spec.particleCount partículas activas, en el orden en que
+// se generaron (espacialmente coherente). Retorna false si no caben.
+bool generateScenario(const ScenarioSpec& spec, ParticleStore& out, ScenarioReport* report = nullptr);
+
+// Modo --generate de la línea de comandos
+int runGenerator(const QStringList& args);
+
+#endif // SCENARIOGENERATOR_H
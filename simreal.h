@@ -0,0 +1,24 @@
+#ifndef SIMREAL_H
+#define SIMREAL_H
+
+// Precisión numérica del núcleo de simulación.
+// Por defecto double; compilar con CONFIG+=sim_float (define
+// SIM_SINGLE_PRECISION) para usar float, que reduce a la mitad la memoria y
+// el ancho de banda y duplica los carriles SIMD.
+#ifdef SIM_SINGLE_PRECISION
+typedef float SimReal;
+#else
+typedef double SimReal;
+#endif
+
+struct SimPoint {
+    SimReal x;
+    SimReal y;
+};
+
+inline const char* simPrecisionName()
+{
+    return sizeof(SimReal) == sizeof(float) ? "float" : "double";
+}
+
+#endif // SIMREAL_H
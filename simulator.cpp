@@ -1,199 +1,984 @@
 #include "simulator.h"
+#include "binaryexport.h"
+#include "stepkernels.h"
 #include <QFile>
 #include <QDebug>
 #include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+namespace {
+
+// Diferencia de coordenadas hacia la imagen más cercana en una caja
+// periódica de largo period; period == 0 = sin envolver
+inline SimReal nearestImage(SimReal d, SimReal period)
+{
+    if (period > 0) {
+        if (d > period / 2) d -= period;
+        else if (d < -period / 2) d += period;
+    }
+    return d;
+}
+
+// Políticas de registro de trayectorias
+
+struct TrajectoryRecorder
+{
+    static void record(QVector<TrajectorySample>& samples, int step, const ParticleColumns& p, int i)
+    {
+        TrajectorySample sample = { step, p.id[i], p.x[i], p.y[i] };
+        samples.append(sample);
+    }
+};
+
+struct NoRecorder
+{
+    static void record(QVector<TrajectorySample>&, int, const ParticleColumns&, int) {}
+};
+
+// Intercala los 16 bits bajos de v con ceros: b15..b0 -> 0 b15 ... 0 b0
+inline quint32 spreadBits(quint32 v)
+{
+    v &= 0xffff;
+    v = (v | (v << 8)) & 0x00ff00ff;
+    v = (v | (v << 4)) & 0x0f0f0f0f;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
+
+// column[k] = column[anterior de k], con el orden en los 32 bits bajos
+template <typename T>
+void permuteColumn(QVector<T>& column, const QVector<quint64>& order)
+{
+    QVector<T> permuted(column.size());
+    for (int k = 0; k < order.size(); ++k) {
+        permuted[k] = column[static_cast<int>(order[k] & 0xffffffffu)];
+    }
+    column.swap(permuted);
+}
+
+} // namespace
+
+// Lo que necesitan los núcleos del paso; lo arma Simulator::stepContext
+struct StepContext
+{
+    ParticleColumns p;
+    SimReal h;
+    SimReal width;
+    SimReal height;
+    double time;
+    qint32 step;
+    const RectPack<SimReal>* rects;
+    const BroadphaseGrid* grid;
+    qint32* cells;
+    QVector<TrajectorySample>* samples;   // del bloque, solo en la pasada fusionada
+};
+
+namespace {
+
+// Pasada fusionada especializada por políticas. Con Binned = false la
+// política de parejas no usa la rejilla y no se calcula la celda.
+template <class Boundary, class Obstacles, class Recorder, bool Binned>
+void sweepKernel(const StepContext& c, int begin, int end, QVector<CollisionEvent>& out,
+                 StepTally& tally)
+{
+    const ParticleColumns& p = c.p;
+
+    // Cada partícula se lee y escribe una sola vez mientras está en caché
+    for (int i = begin; i < end; ++i) {
+        if (!p.active[i]) {
+            if (Binned) c.cells[i] = -1;
+            continue;
+        }
+
+        integrateOne(p, i, c.h, tally);
+        int wall = Boundary::apply(p, i, c.width, c.height);
+        if (wall) logWall(p, i, wall, c.time, out);
+        if (Boundary::absorbs && !p.active[i]) {
+            if (Binned) c.cells[i] = -1;
+            continue;
+        }
+
+        collideWithObstacles<Obstacles>(p, i, *c.rects, c.time, out, tally);
+        tallyParticle(p, i, tally);
+        if (Binned) c.cells[i] = c.grid->cellOf(p.x[i], p.y[i], p.radius[i]);
+        Recorder::record(*c.samples, c.step, p, i);
+    }
+}
+
+// Fases separadas (setFusedSweep(false)) con las mismas políticas
+template <class Boundary>
+void wallKernel(const StepContext& c, int begin, int end, QVector<CollisionEvent>& out)
+{
+    const ParticleColumns& p = c.p;
+    for (int i = begin; i < end; ++i) {
+        if (!p.active[i]) continue;
+        int wall = Boundary::apply(p, i, c.width, c.height);
+        if (wall) logWall(p, i, wall, c.time, out);
+    }
+}
+
+template <class Obstacles>
+void obstacleKernel(const StepContext& c, int begin, int end, QVector<CollisionEvent>& out,
+                    StepTally& tally)
+{
+    const ParticleColumns& p = c.p;
+    for (int i = begin; i < end; ++i) {
+        if (!p.active[i]) continue;
+        collideWithObstacles<Obstacles>(p, i, *c.rects, c.time, out, tally);
+        tallyParticle(p, i, tally);
+    }
+}
+
+// Instancia de sweepKernel para una combinación elegida en tiempo de
+// ejecución: un nivel de selección por parámetro de la plantilla
+template <class Boundary, class Obstacles, class Recorder>
+SweepKernel selectBinning(bool binned)
+{
+    return binned ? &sweepKernel<Boundary, Obstacles, Recorder, true>
+                  : &sweepKernel<Boundary, Obstacles, Recorder, false>;
+}
+
+template <class Boundary, class Obstacles>
+SweepKernel selectRecorder(bool recording, bool binned)
+{
+    return recording ? selectBinning<Boundary, Obstacles, TrajectoryRecorder>(binned)
+                     : selectBinning<Boundary, Obstacles, NoRecorder>(binned);
+}
+
+template <class Boundary>
+SweepKernel selectObstacles(Simulator::ObstaclePolicy obstacles, bool recording, bool binned)
+{
+    switch (obstacles) {
+    case Simulator::ElasticObstacles:
+        return selectRecorder<Boundary, ElasticResponse>(recording, binned);
+    case Simulator::IgnoreObstacles:
+        return selectRecorder<Boundary, NoResponse>(recording, binned);
+    default:
+        return selectRecorder<Boundary, InelasticResponse>(recording, binned);
+    }
+}
+
+} // namespace
 
 Simulator::Simulator(double boxWidth, double boxHeight, double deltaT)
-    : box(boxWidth, boxHeight), dt(deltaT), currentTime(0.0)
+    : box(boxWidth, boxHeight), dt(deltaT), currentTime(0.0), currentStep(0),
+    memoryPolicy(FailFast), storageFull(false),
+    trajectories(&arena), collisions(&arena), recordTrajectories(true),
+    stateStream(nullptr), streamInterval(1),
+    pool(nullptr), deterministic(true), minRadius(std::numeric_limits<SimReal>::max()),
+    maxRadius(0), hierarchicalGrid(true), fusedSweep(true),
+    reorderEvery(0), reordered(false),
+    boundaryPolicy(ReflectWalls), pairPolicy(MergePairs), obstaclePolicy(InelasticObstacles),
+    frame()
 {
+    selectKernels();
+}
+
+Simulator::~Simulator()
+{
+    delete pool;
 }
 
 void Simulator::addParticle(const Particle& particle)
 {
+    slotOf.append(particles.size());
+    particleIds.append(particles.size());
+    obstacleContact.append(-1);
     particles.append(particle);
-    trajectories.append(QVector<QPointF>());
+    minRadius = qMin(minRadius, SimReal(particle.getRadius()));
+    maxRadius = qMax(maxRadius, SimReal(particle.getRadius()));
+}
+
+void Simulator::addParticles(const ParticleStore& store)
+{
+    const int first = particles.size();
+    const int count = store.size();
+    particles.resize(first + count);
+    std::copy(store.x.constBegin(), store.x.constEnd(), particles.x.begin() + first);
+    std::copy(store.y.constBegin(), store.y.constEnd(), particles.y.begin() + first);
+    std::copy(store.vx.constBegin(), store.vx.constEnd(), particles.vx.begin() + first);
+    std::copy(store.vy.constBegin(), store.vy.constEnd(), particles.vy.begin() + first);
+    std::copy(store.mass.constBegin(), store.mass.constEnd(), particles.mass.begin() + first);
+    std::copy(store.radius.constBegin(), store.radius.constEnd(), particles.radius.begin() + first);
+    std::copy(store.active.constBegin(), store.active.constEnd(), particles.active.begin() + first);
+    registerParticles(first);
+}
+
+void Simulator::registerParticles(int first)
+{
+    // Los IDs nuevos siguen a los existentes, en el orden de llegada
+    const int n = particles.size();
+    particleIds.resize(n);
+    slotOf.resize(n);
+    obstacleContact.resize(n);
+    for (int i = first; i < n; ++i) {
+        particleIds[i] = i;
+        slotOf[i] = i;
+        obstacleContact[i] = -1;
+        minRadius = qMin(minRadius, particles.radius[i]);
+        maxRadius = qMax(maxRadius, particles.radius[i]);
+    }
 }
 
 void Simulator::addObstacle(const Obstacle& obstacle)
 {
     obstacles.append(obstacle);
+    obstacleRects.append(obstacle.getRect());
 }
 
-void Simulator::run(double duration)
+bool Simulator::loadInitialConditions(const QString& filename)
+{
+    InitialConditionsFile source;
+    if (!source.open(filename)) {
+        return false;
+    }
+    if (SimReal(source.boxWidth()) != box.getWidth() || SimReal(source.boxHeight()) != box.getHeight()) {
+        qWarning() << "La caja del archivo" << filename << "(" << source.boxWidth() << "x"
+                   << source.boxHeight() << ") no coincide con la del simulador";
+        return false;
+    }
+
+    // Una sola reserva por columna; las partículas nuevas van al final
+    const int first = particles.size();
+    const int count = source.particleCount();
+    particles.resize(first + count);
+    source.readColumn(InitialConditionsFile::X, particles.x.data() + first);
+    source.readColumn(InitialConditionsFile::Y, particles.y.data() + first);
+    source.readColumn(InitialConditionsFile::VX, particles.vx.data() + first);
+    source.readColumn(InitialConditionsFile::VY, particles.vy.data() + first);
+    source.readColumn(InitialConditionsFile::Mass, particles.mass.data() + first);
+    source.readColumn(InitialConditionsFile::Radius, particles.radius.data() + first);
+    std::memcpy(particles.active.data() + first, source.activeFlags(), count);
+    registerParticles(first);
+
+    obstacles.reserve(obstacles.size() + source.obstacleCount());
+    for (int i = 0; i < source.obstacleCount(); ++i) {
+        QRectF rect = source.obstacle(i);
+        addObstacle(Obstacle(rect.x(), rect.y(), rect.width(), rect.height()));
+    }
+    return true;
+}
+
+bool Simulator::saveInitialConditions(const QString& filename) const
+{
+    QVector<QRectF> rects;
+    rects.reserve(obstacles.size());
+    for (const Obstacle& obstacle : obstacles) rects.append(obstacle.getRect());
+
+    // Tras reordenar, las posiciones ya no son los IDs: se escribe por ID
+    return writeInitialConditions(filename, box.getWidth(), box.getHeight(), particles,
+                                  reordered ? slotOf : QVector<int>(), rects);
+}
+
+void Simulator::setMemoryBudget(qint64 bytes, MemoryPolicy policy, const QString& spillPrefix)
+{
+    arena.setBudget(bytes);
+    memoryPolicy = policy;
+
+    if (policy == SpillToDisk) {
+        trajectories.setSpillFile(spillPrefix + "_trayectorias.bin");
+        collisions.setSpillFile(spillPrefix + "_colisiones.bin");
+    } else {
+        trajectories.setSpillFile(QString());
+        collisions.setSpillFile(QString());
+    }
+}
+
+qint64 Simulator::estimateFootprint(double duration) const
+{
+    qint64 steps = static_cast<qint64>(duration / dt);
+
+    int activeCount = 0;
+    for (int i = 0; i < particles.size(); ++i) {
+        activeCount += particles.active[i];
+    }
+
+    // Las fusiones solo reducen las partículas activas: es una cota superior
+    qint64 samples = recordTrajectories ? qint64(activeCount) * steps : 0;
+    qint64 chunk = trajectories.chunkBytes();
+    qint64 trajectoryBytes = (samples * qint64(sizeof(TrajectorySample)) + chunk - 1) / chunk * chunk;
+
+    return trajectoryBytes + collisions.chunkBytes();
+}
+
+bool Simulator::setStatisticsOutput(const QString& filename, int everySteps)
+{
+    return statistics.setSeriesFile(filename, everySteps);
+}
+
+void Simulator::setStateStream(StateStreamWriter* stream, int everySteps)
+{
+    stateStream = stream;
+    streamInterval = qMax(1, everySteps);
+}
+
+bool Simulator::prepareRun(double duration)
 {
     int steps = static_cast<int>(duration / dt);
 
     qDebug() << "Ejecutando simulación con" << steps << "pasos...";
 
-    for (int step = 0; step < steps; ++step) {
-        currentTime = step * dt;
+    qint64 estimate = estimateFootprint(duration) + arena.getUsed();
+    qDebug() << "Memoria estimada para datos registrados:" << estimate << "bytes";
+
+    if (arena.wouldExceed(estimate - arena.getUsed())) {
+        if (memoryPolicy == FailFast) {
+            qWarning() << "La corrida excede el presupuesto de memoria ("
+                       << arena.getBudget() << "bytes); no se ejecuta.";
+            return false;
+        }
+        qDebug() << "La corrida excede el presupuesto; se volcarán datos a disco.";
+    }
+
+    // Con volcado, cada registro necesita su bloque desde el principio (ver
+    // ChunkedVector::reserveFirstChunk); si ni eso cabe, no se ejecuta
+    if (memoryPolicy == SpillToDisk) {
+        if (!collisions.reserveFirstChunk()
+            || (recordTrajectories && !trajectories.reserveFirstChunk())) {
+            qWarning() << "El presupuesto de memoria (" << arena.getBudget()
+                       << "bytes) no alcanza para un bloque por registro; no se ejecuta.";
+            return false;
+        }
+    }
+
+    selectKernels();
+    return true;
+}
 
-        // Actualizar posiciones de todas las partículas
-        updateParticles();
+void Simulator::selectKernels()
+{
+    // Las ramas por política quedan aquí, una vez por corrida
+    const bool binned = pairPolicy != IgnorePairs;
+    switch (boundaryPolicy) {
+    case PeriodicWalls:
+        sweepPass = selectObstacles<PeriodicBoundary>(obstaclePolicy, recordTrajectories, binned);
+        wallPass = &wallKernel<PeriodicBoundary>;
+        break;
+    case AbsorbWalls:
+        sweepPass = selectObstacles<AbsorbBoundary>(obstaclePolicy, recordTrajectories, binned);
+        wallPass = &wallKernel<AbsorbBoundary>;
+        break;
+    default:
+        sweepPass = selectObstacles<ReflectBoundary>(obstaclePolicy, recordTrajectories, binned);
+        wallPass = &wallKernel<ReflectBoundary>;
+        break;
+    }
 
-        // Manejar todos los tipos de colisiones
-        handleWallCollisions();
-        handleObstacleCollisions();
-        handleParticleCollisions();
+    switch (obstaclePolicy) {
+    case ElasticObstacles:
+        obstaclePass = &obstacleKernel<ElasticResponse>;
+        break;
+    case IgnoreObstacles:
+        obstaclePass = &obstacleKernel<NoResponse>;
+        break;
+    default:
+        obstaclePass = &obstacleKernel<InelasticResponse>;
+        break;
+    }
+}
 
-        // Registrar posiciones actuales para la trayectoria
-        recordPositions();
+StepContext Simulator::stepContext()
+{
+    StepContext context = { ParticleColumns(particles, particleIds, obstacleContact),
+                            static_cast<SimReal>(dt), box.getWidth(), box.getHeight(),
+                            currentTime, currentStep, &obstacleRects, &grid, cellOf.data(),
+                            nullptr };
+    return context;
+}
+
+bool Simulator::run(double duration)
+{
+    if (!prepareRun(duration)) {
+        return false;
+    }
+
+    int steps = static_cast<int>(duration / dt);
+    for (int step = 0; step < steps; ++step) {
+        if (!advance()) {
+            return false;
+        }
 
         // Mostrar progreso cada 10% de la simulación
-        if (step % (steps / 10) == 0) {
+        if (steps >= 10 && step % (steps / 10) == 0) {
             qDebug() << "Progreso:" << (step * 100 / steps) << "%";
         }
     }
 
     qDebug() << "Simulación completada.";
     qDebug() << "Total de colisiones registradas:" << collisions.size();
+    qDebug() << "Pico de memoria de datos registrados:" << arena.getPeak() << "bytes";
+    return true;
 }
 
-void Simulator::updateParticles()
+bool Simulator::advance()
 {
-    for (int i = 0; i < particles.size(); ++i) {
-        if (particles[i].isActive()) {
-            particles[i].updatePosition(dt);
+    currentTime = currentStep * dt;
+
+    if (reorderEvery > 0 && currentStep % reorderEvery == 0) {
+        reorderParticles();
+    }
+
+    // Fases por bloques de partículas (en paralelo si hay hilos);
+    // los eventos de cada fase se juntan en stepEvents
+    const int n = particles.size();
+    const int blocks = (n + blockSize - 1) / blockSize;
+    stepEvents.clear();
+    blockTallies.fill(StepTally(), blocks);
+
+    // Solo las políticas con parejas usan la rejilla
+    const bool binned = pairPolicy != IgnorePairs;
+    if (binned) {
+        // Las fusiones solo agrandan: el radio mínimo es el de la entrada
+        cellOf.resize(n);
+        SimReal finest = hierarchicalGrid ? qMin(minRadius, maxRadius) : maxRadius;
+        grid.configure(box.getWidth(), box.getHeight(), 2 * finest, 2 * maxRadius, qMax(64, 2 * n));
+        grid.setPeriodic(boundaryPolicy == PeriodicWalls);
+    }
+
+    if (fusedSweep) {
+        // Una sola pasada por bloque: integrar, paredes, obstáculos,
+        // celda de la rejilla y muestra de trayectoria
+        if (blockSamples.size() < blocks) blockSamples.resize(blocks);
+        runBlocks([this](int begin, int end, QVector<CollisionEvent>& out) {
+            sweepBlock(begin, end, out, blockTallies[begin / blockSize]);
+        });
+    } else {
+        runBlocks([this](int begin, int end, QVector<CollisionEvent>& out) {
+            Q_UNUSED(out);
+            updateParticles(begin, end, blockTallies[begin / blockSize]);
+        });
+        runBlocks([this](int begin, int end, QVector<CollisionEvent>& out) {
+            handleWallCollisions(begin, end, out);
+        });
+        runBlocks([this](int begin, int end, QVector<CollisionEvent>& out) {
+            handleObstacleCollisions(begin, end, out, blockTallies[begin / blockSize]);
+        });
+        if (binned) {
+            runBlocks([this](int begin, int end, QVector<CollisionEvent>& out) {
+                Q_UNUSED(out);
+                binParticles(begin, end);
+            });
+        }
+    }
+    if (binned) {
+        grid.build(cellOf.constData(), n);
+    }
+
+    for (const StepTally& tally : blockTallies) {
+        statistics.addTally(tally);
+    }
+
+    int first = -1;
+    int second = -1;
+    if (pairPolicy == MergePairs) {
+        handleParticleCollisions(first, second);
+    } else if (pairPolicy == ElasticPairs) {
+        handleElasticCollisions();
+    }
+
+    // Orden canónico de los eventos del paso: (tiempo, tipo, IDs)
+    if (deterministic) {
+        std::stable_sort(stepEvents.begin(), stepEvents.end(), eventOrder);
+    }
+    for (const CollisionEvent& event : stepEvents) {
+        recordEvent(event);
+        statistics.countEvent(event.kind);
+    }
+
+    // Registrar posiciones actuales para la trayectoria
+    if (recordTrajectories) {
+        if (fusedSweep) {
+            flushSamples(first, second);
+        } else {
+            recordPositions();
         }
     }
+    currentStep++;
+    statistics.endStep(currentStep, currentStep * dt);
+
+    // Publicar el cuadro para visores externos (nunca bloquea)
+    if (stateStream && currentStep % streamInterval == 0) {
+        stateStream->publish(currentStep, currentTime, collisions.size(), particles);
+    }
+
+    if (storageFull) {
+        qWarning() << "Presupuesto de memoria agotado en t=" << currentTime
+                   << "s; corrida detenida.";
+        return false;
+    }
+
+    StepFrame view = { currentStep, currentTime, &particles, &particleIds, &stepEvents, &statistics };
+    frame = view;
+    return true;
 }
 
-void Simulator::handleWallCollisions()
+Simulator::StepRange::iterator Simulator::StepRange::begin()
 {
-    for (int i = 0; i < particles.size(); ++i) {
-        if (!particles[i].isActive()) continue;
+    int steps = static_cast<int>(duration / sim->dt);
+    if (steps <= 0 || !sim->prepareRun(duration) || !sim->advance()) {
+        return end();
+    }
+    return iterator(sim, steps);
+}
 
-        QPointF pos = particles[i].getPosition();
-        QPointF vel = particles[i].getVelocity();
-        double radius = particles[i].getRadius();
+Simulator::StepRange::iterator& Simulator::StepRange::iterator::operator++()
+{
+    remaining--;
+    if (remaining > 0 && !sim->advance()) {
+        remaining = 0;
+    }
+    return *this;
+}
 
-        int collision = box.checkWallCollision(pos.x(), pos.y(), radius);
+void Simulator::recordEvent(const CollisionEvent& event)
+{
+    if (!collisions.append(event)) {
+        storageFull = true;
+    }
+}
 
-        if (collision > 0) {
-            QString wall;
+bool Simulator::eventOrder(const CollisionEvent& a, const CollisionEvent& b)
+{
+    if (a.time != b.time) return a.time < b.time;
+    if (a.kind != b.kind) return a.kind < b.kind;
+    if (a.particleA != b.particleA) return a.particleA < b.particleA;
+    return a.other < b.other;
+}
 
-            // Colisiones perfectamente elásticas con las paredes
-            if (collision == 1) {  // pared izquierda
-                vel.setX(-vel.x());
-                pos.setX(radius);
-                wall = "izquierda";
-            }
-            else if (collision == 2) {  // pared derecha
-                vel.setX(-vel.x());
-                pos.setX(box.getWidth() - radius);
-                wall = "derecha";
-            }
-            else if (collision == 3) {  // pared superior
-                vel.setY(-vel.y());
-                pos.setY(radius);
-                wall = "arriba";
-            }
-            else if (collision == 4) {  // pared inferior
-                vel.setY(-vel.y());
-                pos.setY(box.getHeight() - radius);
-                wall = "abajo";
-            }
+void Simulator::reorderParticles()
+{
+    const int n = particles.size();
+    const SimReal scaleX = SimReal(65535) / box.getWidth();
+    const SimReal scaleY = SimReal(65535) / box.getHeight();
+
+    // Clave (Morton << 32 | posición); las inactivas van al final
+    QVector<quint64> order(n);
+    for (int i = 0; i < n; ++i) {
+        quint32 code = 0xffffffffu;
+        if (particles.active[i]) {
+            quint32 qx = static_cast<quint32>(qBound(SimReal(0), particles.x[i] * scaleX, SimReal(65535)));
+            quint32 qy = static_cast<quint32>(qBound(SimReal(0), particles.y[i] * scaleY, SimReal(65535)));
+            code = spreadBits(qx) | (spreadBits(qy) << 1);
+        }
+        order[i] = (quint64(code) << 32) | quint32(i);
+    }
+    std::sort(order.begin(), order.end());
+
+    permuteColumn(particles.x, order);
+    permuteColumn(particles.y, order);
+    permuteColumn(particles.vx, order);
+    permuteColumn(particles.vy, order);
+    permuteColumn(particles.mass, order);
+    permuteColumn(particles.radius, order);
+    permuteColumn(particles.active, order);
+    permuteColumn(particleIds, order);
+    permuteColumn(obstacleContact, order);
+
+    for (int k = 0; k < n; ++k) {
+        slotOf[particleIds[k]] = k;
+    }
+    reordered = true;
+}
+
+void Simulator::setThreadCount(int threads)
+{
+    threads = qMax(1, threads);
+    if (threads == threadCount()) return;
+
+    delete pool;
+    pool = (threads > 1) ? new WorkerPool(threads) : nullptr;
+}
+
+void Simulator::runBlocks(const std::function<void(int, int, QVector<CollisionEvent>&)>& phase)
+{
+    const int n = particles.size();
+    const int blocks = (n + blockSize - 1) / blockSize;
+    const int threads = threadCount();
 
-            particles[i].setVelocity(vel);
-            particles[i].setPosition(pos);
+    // Modo determinista: un búfer por bloque, concatenados en orden de
+    // bloque. Modo rápido: un búfer por hilo, en el orden en que los hilos
+    // tomaron los bloques.
+    int buffers = (deterministic || threads == 1) ? blocks : threads;
+    if (eventBuffers.size() < buffers) eventBuffers.resize(buffers);
+    for (int k = 0; k < buffers; ++k) eventBuffers[k].clear();
 
-            // Registrar evento de colisión
-            CollisionEvent event;
-            event.time = currentTime;
-            event.description = QString("Partícula %1 colisiona con pared %2")
-                                    .arg(i).arg(wall);
-            collisions.append(event);
+    if (threads == 1) {
+        for (int b = 0; b < blocks; ++b) {
+            phase(b * blockSize, qMin(n, (b + 1) * blockSize), eventBuffers[b]);
         }
+    } else {
+        std::atomic<int> nextBlock(0);
+        pool->run([&](int worker) {
+            int b;
+            while ((b = nextBlock.fetch_add(1)) < blocks) {
+                QVector<CollisionEvent>& out = eventBuffers[deterministic ? b : worker];
+                phase(b * blockSize, qMin(n, (b + 1) * blockSize), out);
+            }
+        });
+    }
+
+    for (int k = 0; k < buffers; ++k) {
+        stepEvents += eventBuffers[k];
     }
 }
 
-void Simulator::handleObstacleCollisions()
+void Simulator::sweepBlock(int begin, int end, QVector<CollisionEvent>& out, StepTally& tally)
 {
-    for (int i = 0; i < particles.size(); ++i) {
-        if (!particles[i].isActive()) continue;
-
-        QPointF pos = particles[i].getPosition();
-        QPointF vel = particles[i].getVelocity();
-        double radius = particles[i].getRadius();
-
-        for (int j = 0; j < obstacles.size(); ++j) {
-            if (obstacles[j].checkCollision(pos, radius)) {
-                // Calcular posición anterior para determinar lado de colisión
-                QPointF prevPos = pos - vel * dt;
-                int side = obstacles[j].getCollisionSide(pos, prevPos);
-
-                // Aplicar coeficiente de restitución (colisión inelástica)
-                // v'⊥ = -ε * v⊥  (componente perpendicular)
-                // v'∥ = v∥      (componente paralela se mantiene)
-
-                if (side == 0 || side == 2) {  // arriba o abajo (perpendicular en Y)
-                    vel.setY(-vel.y() * restitutionCoefficient);
-                } else {  // izquierda o derecha (perpendicular en X)
-                    vel.setX(-vel.x() * restitutionCoefficient);
+    StepContext context = stepContext();
+    context.samples = &blockSamples[begin / blockSize];
+    context.samples->clear();
+    sweepPass(context, begin, end, out, tally);
+}
+
+void Simulator::updateParticles(int begin, int end, StepTally& tally)
+{
+    ParticleColumns p(particles, particleIds, obstacleContact);
+    const SimReal h = static_cast<SimReal>(dt);
+    for (int i = begin; i < end; ++i) {
+        if (p.active[i]) integrateOne(p, i, h, tally);
+    }
+}
+
+void Simulator::handleWallCollisions(int begin, int end, QVector<CollisionEvent>& out)
+{
+    wallPass(stepContext(), begin, end, out);
+}
+
+void Simulator::handleObstacleCollisions(int begin, int end, QVector<CollisionEvent>& out,
+                                         StepTally& tally)
+{
+    obstaclePass(stepContext(), begin, end, out, tally);
+}
+
+void Simulator::binParticles(int begin, int end)
+{
+    ParticleColumns p(particles, particleIds, obstacleContact);
+    for (int i = begin; i < end; ++i) {
+        cellOf[i] = p.active[i] ? grid.cellOf(p.x[i], p.y[i], p.radius[i]) : -1;
+    }
+}
+
+bool Simulator::findMergePair(int& first, int& second) const
+{
+    const int n = particles.size();
+    const SimReal* x = particles.x.constData();
+    const SimReal* y = particles.y.constData();
+    const SimReal* r = particles.radius.constData();
+    const quint8* active = particles.active.constData();
+    const qint32* id = particleIds.constData();
+
+    // Sin reordenar, posición == ID y las celdas están también en orden de ID
+    const bool ordered = !reordered;
+
+    // Con paredes periódicas la distancia se mide a la imagen más cercana
+    const SimReal periodX = (boundaryPolicy == PeriodicWalls) ? box.getWidth() : SimReal(0);
+    const SimReal periodY = (boundaryPolicy == PeriodicWalls) ? box.getHeight() : SimReal(0);
+
+    // Pareja codificada como (ID menor << 32 | ID mayor)
+    const quint64 none = ~quint64(0);
+
+    // Menor pareja de i por debajo de 'bound' en los niveles [firstLevel,
+    // lastLevel] de la rejilla; en su propio nivel (sameLevel) solo con ID
+    // mayor. Sin reordenar, las claves crecen dentro de cada celda.
+    auto search = [=](int i, bool sameLevel, int firstLevel, int lastLevel, quint64 bound) {
+        quint64 best = bound;
+        grid.forEachCandidateCell(x[i], y[i], r[i], [&](const qint32* items, int count) {
+            for (int k = 0; k < count; ++k) {
+                int j = items[k];
+                if (sameLevel && id[j] <= id[i]) continue;
+                quint64 key = (quint64(qMin(id[i], id[j])) << 32) | quint64(qMax(id[i], id[j]));
+                if (key >= best) {
+                    if (ordered) break;
+                    continue;
+                }
+
+                // Colisión si la distancia entre centros es menor que la suma
+                // de radios (comparación al cuadrado)
+                SimReal dx = nearestImage(x[i] - x[j], periodX);
+                SimReal dy = nearestImage(y[i] - y[j], periodY);
+                SimReal sumR = r[i] + r[j];
+                if (dx * dx + dy * dy < sumR * sumR) {
+                    best = key;
+                    if (ordered) break;
+                }
+            }
+        }, firstLevel, lastLevel);
+        return best;
+    };
+
+    // Como en handleElasticCollisions, cada fila consulta su nivel (parejas
+    // con ID mayor) y los superiores (todas), así que el gigante no recorre
+    // los niveles finos
+    auto rowPair = [=](int i, quint64 bound) {
+        if (!active[i]) return bound;
+        const int level = grid.levelOf(cellOf[i]);
+        quint64 best = search(i, true, level, level, bound);
+        return search(i, false, level + 1, BroadphaseGrid::maxLevels - 1, best);
+    };
+
+    // Las filas se recorren en orden de posición (memoria contigua). La
+    // pareja menor empieza por el menor ID de los dos: una fila cuyo ID
+    // supera al primero de la mejor pareja hallada ya no puede ganar. Sin
+    // reordenar, posición == ID y la primera fila con pareja termina.
+    auto beaten = [=](int i, quint64 current) {
+        return current != none && quint64(id[i]) > (current >> 32);
+    };
+
+    quint64 pair = none;
+    bool exhaustive = true;
+    if (threadCount() == 1) {
+        // Revisar todas las parejas de partículas en orden
+        for (int i = 0; i < n; ++i) {
+            if (beaten(i, pair)) {
+                if (ordered) break;
+                continue;
+            }
+            pair = rowPair(i, pair);
+        }
+    } else {
+        std::atomic<quint64> best(none);
+        std::atomic<int> nextRow(0);
+        const int rowBlock = 16;
+        const bool canonical = deterministic;
+        exhaustive = canonical;
+
+        pool->run([&](int worker) {
+            Q_UNUSED(worker);
+            int row;
+            while ((row = nextRow.fetch_add(rowBlock)) < n) {
+                quint64 current = best.load(std::memory_order_relaxed);
+                if (canonical) {
+                    // Filas posteriores a la mejor pareja ya no pueden ganar
+                    if (ordered && beaten(row, current)) return;
+                } else if (current != none) {
+                    // Modo rápido: basta con la primera pareja que aparezca
+                    return;
                 }
 
-                particles[i].setVelocity(vel);
-
-                // Registrar evento de colisión
-                CollisionEvent event;
-                event.time = currentTime;
-                QString sideStr;
-                switch(side) {
-                case 0: sideStr = "arriba"; break;
-                case 1: sideStr = "derecha"; break;
-                case 2: sideStr = "abajo"; break;
-                case 3: sideStr = "izquierda"; break;
+                for (int i = row; i < qMin(n, row + rowBlock); ++i) {
+                    quint64 seen = best.load(std::memory_order_relaxed);
+                    if (beaten(i, seen)) continue;
+                    quint64 candidate = rowPair(i, seen);
+                    if (candidate >= seen) continue;
+
+                    while (candidate < seen && !best.compare_exchange_weak(seen, candidate)) {
+                    }
+                    if (ordered) break;
                 }
-                event.description = QString("Partícula %1 colisiona con obstáculo %2 (lado %3)")
-                                        .arg(i).arg(j).arg(sideStr);
-                collisions.append(event);
+            }
+        });
+        pair = best.load();
+    }
 
-                // Solo procesar una colisión por partícula por paso de tiempo
-                break;
+    // Falta la pareja de una partícula con otra de un nivel superior e ID
+    // menor cuando la fila de la primera quedó vencida: la busca el gigante
+    // hacia los niveles inferiores, solo si su ID aún puede ganar
+    if (exhaustive && pair != none && grid.levelCount() > 1) {
+        for (int i = 0; i < n; ++i) {
+            if (beaten(i, pair)) {
+                if (ordered) break;
+                continue;
             }
+            if (!active[i]) continue;
+            const int level = grid.levelOf(cellOf[i]);
+            if (level > 0) pair = search(i, false, 0, level - 1, pair);
         }
     }
+
+    if (pair == none) return false;
+    first = slotOf[static_cast<int>(pair >> 32)];
+    second = slotOf[static_cast<int>(pair & 0xffffffffu)];
+    return true;
 }
 
-void Simulator::handleParticleCollisions()
+void Simulator::handleParticleCollisions(int& first, int& second)
 {
-    // Revisar todas las parejas de partículas
-    for (int i = 0; i < particles.size(); ++i) {
-        if (!particles[i].isActive()) continue;
-
-        for (int j = i + 1; j < particles.size(); ++j) {
-            if (!particles[j].isActive()) continue;
-
-            // Verificar si hay colisión
-            if (particles[i].checkCollisionWithParticle(particles[j])) {
-                // Colisión completamente inelástica: las partículas se fusionan
-                Particle merged = Particle::merge(particles[i], particles[j]);
-
-                // Registrar evento de colisión
-                CollisionEvent event;
-                event.time = currentTime;
-                event.description = QString("Partícula %1 (masa=%.2f) y Partícula %2 (masa=%.2f) se fusionan en nueva partícula (masa=%.2f)")
-                                        .arg(i)
-                                        .arg(particles[i].getMass())
-                                        .arg(j)
-                                        .arg(particles[j].getMass())
-                                        .arg(merged.getMass());
-                collisions.append(event);
-
-                qDebug() << "Fusión detectada en t=" << currentTime << "s:"
-                         << "Partícula" << i << "+ Partícula" << j;
-
-                // Desactivar las partículas originales
-                particles[i].setActive(false);
-                particles[j].setActive(false);
-
-                // Agregar la nueva partícula fusionada
-                particles.append(merged);
-                trajectories.append(QVector<QPointF>());
-
-                // Solo procesar una fusión a la vez
-                return;
+    int i, j;
+    if (!findMergePair(i, j)) return;
+    first = i;
+    second = j;
+
+    // Colisión completamente inelástica: las partículas se fusionan
+    Particle a = particles.get(i);
+    Particle b = particles.get(j);
+    if (boundaryPolicy == PeriodicWalls) {
+        // La pareja puede tocarse a través del borde: b se lleva a la imagen
+        // junto a a y el centro de masa vuelve a la caja
+        const SimReal w = box.getWidth();
+        const SimReal h = box.getHeight();
+        QPointF pa = a.getPosition();
+        QPointF pb = b.getPosition();
+        b.setPosition(QPointF(pa.x() - nearestImage(SimReal(pa.x() - pb.x()), w),
+                              pa.y() - nearestImage(SimReal(pa.y() - pb.y()), h)));
+    }
+    Particle merged = Particle::merge(a, b);
+    if (boundaryPolicy == PeriodicWalls) {
+        QPointF c = merged.getPosition();
+        const double w = box.getWidth();
+        const double h = box.getHeight();
+        merged.setPosition(QPointF(c.x() + (c.x() < 0 ? w : 0) - (c.x() >= w ? w : 0),
+                                   c.y() + (c.y() < 0 ? h : 0) - (c.y() >= h ? h : 0)));
+    }
+    statistics.addMerge(a, b, merged);
+
+    // Registrar evento de colisión
+    CollisionEvent event = {};
+    event.time = currentTime;
+    event.kind = MergeCollision;
+    event.particleA = particleIds[i];
+    event.other = particleIds[j];
+    event.merged = particles.size();   // los IDs nuevos siguen al último
+    event.massA = particles.mass[i];
+    event.massB = particles.mass[j];
+    event.mergedMass = merged.getMass();
+    stepEvents.append(event);
+
+    qDebug() << "Fusión detectada en t=" << currentTime << "s:"
+             << "Partícula" << particleIds[i] << "+ Partícula" << particleIds[j];
+
+    // Desactivar las partículas originales
+    particles.active[i] = 0;
+    particles.active[j] = 0;
+
+    // Agregar la nueva partícula fusionada (solo una fusión por paso)
+    slotOf.append(particles.size());
+    particleIds.append(particles.size());
+    obstacleContact.append(-1);
+    particles.append(merged);
+    maxRadius = qMax(maxRadius, SimReal(merged.getRadius()));
+}
+
+void Simulator::handleElasticCollisions()
+{
+    const int n = particles.size();
+    const SimReal* x = particles.x.constData();
+    const SimReal* y = particles.y.constData();
+    const SimReal* r = particles.radius.constData();
+    const SimReal* m = particles.mass.constData();
+    const quint8* active = particles.active.constData();
+    const qint32* id = particleIds.constData();
+    SimReal* vx = particles.vx.data();
+    SimReal* vy = particles.vy.data();
+    const SimReal periodX = (boundaryPolicy == PeriodicWalls) ? box.getWidth() : SimReal(0);
+    const SimReal periodY = (boundaryPolicy == PeriodicWalls) ? box.getHeight() : SimReal(0);
+
+    // Parejas en contacto codificadas como (ID(i) << 32 | ID(j)), ID(i) < ID(j).
+    // Se buscan por filas en la rejilla (en paralelo si hay hilos) y se
+    // resuelven en orden de ID: el resultado no depende de los hilos ni del
+    // reordenamiento. Cada partícula consulta solo su nivel de la rejilla
+    // (parejas con ID mayor) y los superiores (todas): así cada pareja sale
+    // una vez, de la más pequeña, y el gigante no recorre los niveles finos
+    auto collect = [&](int begin, int end, QVector<quint64>& found) {
+        for (int i = begin; i < end; ++i) {
+            if (!active[i]) continue;
+            const int own = grid.levelOf(cellOf[i]);
+            auto test = [&](const qint32* items, int count, bool sameLevel) {
+                for (int k = 0; k < count; ++k) {
+                    int j = items[k];
+                    if (sameLevel && id[j] <= id[i]) continue;
+                    SimReal dx = nearestImage(x[i] - x[j], periodX);
+                    SimReal dy = nearestImage(y[i] - y[j], periodY);
+                    SimReal sumR = r[i] + r[j];
+                    if (dx * dx + dy * dy < sumR * sumR) {
+                        quint64 a = quint64(qMin(id[i], id[j]));
+                        quint64 b = quint64(qMax(id[i], id[j]));
+                        found.append((a << 32) | b);
+                    }
+                }
+            };
+            grid.forEachCandidateCell(x[i], y[i], r[i], [&](const qint32* items, int count) {
+                test(items, count, true);
+            }, own, own);
+            grid.forEachCandidateCell(x[i], y[i], r[i], [&](const qint32* items, int count) {
+                test(items, count, false);
+            }, own + 1);
+        }
+    };
+
+    const int threads = threadCount();
+    if (pairBuffers.size() < threads) pairBuffers.resize(threads);
+    for (int k = 0; k < threads; ++k) pairBuffers[k].clear();
+
+    if (threads == 1) {
+        collect(0, n, pairBuffers[0]);
+    } else {
+        std::atomic<int> nextRow(0);
+        const int rowBlock = 256;
+        pool->run([&](int worker) {
+            int row;
+            while ((row = nextRow.fetch_add(rowBlock)) < n) {
+                collect(row, qMin(n, row + rowBlock), pairBuffers[worker]);
             }
+        });
+    }
+
+    QVector<quint64>& pairs = pairBuffers[0];
+    for (int k = 1; k < threads; ++k) pairs += pairBuffers[k];
+    std::sort(pairs.begin(), pairs.end());
+
+    for (quint64 pair : pairs) {
+        const int i = slotOf[static_cast<int>(pair >> 32)];
+        const int j = slotOf[static_cast<int>(pair & 0xffffffffu)];
+
+        // Normal sin normalizar de i hacia j (a través del borde si es
+        // periódico); solo rebotan si se acercan
+        SimReal nx = nearestImage(x[j] - x[i], periodX);
+        SimReal ny = nearestImage(y[j] - y[i], periodY);
+        SimReal distance2 = nx * nx + ny * ny;
+        SimReal approach = (vx[j] - vx[i]) * nx + (vy[j] - vy[i]) * ny;
+        if (distance2 <= 0 || approach >= 0) continue;
+
+        // Impulso a lo largo de la normal con restitución 1: se conservan
+        // momento y energía, así que las sumas del paso no cambian
+        SimReal impulse = -2 * approach / ((1 / m[i] + 1 / m[j]) * distance2);
+        vx[i] -= impulse / m[i] * nx;
+        vy[i] -= impulse / m[i] * ny;
+        vx[j] += impulse / m[j] * nx;
+        vy[j] += impulse / m[j] * ny;
+
+        // Registrar evento de colisión
+        CollisionEvent event = {};
+        event.time = currentTime;
+        event.kind = ElasticCollision;
+        event.particleA = id[i];
+        event.other = id[j];
+        event.merged = -1;
+        event.massA = m[i];
+        event.massB = m[j];
+        stepEvents.append(event);
+    }
+}
+
+void Simulator::flushSamples(int first, int second)
+{
+    // Las partículas fusionadas en este paso ya no se registran
+    for (int slot : { first, second }) {
+        if (slot < 0) continue;
+        QVector<TrajectorySample>& samples = blockSamples[slot / blockSize];
+        const qint32 id = particleIds[slot];
+        auto it = std::find_if(samples.begin(), samples.end(),
+                               [id](const TrajectorySample& s) { return s.particleId == id; });
+        if (it != samples.end()) samples.erase(it);
+    }
+
+    const int blocks = (particles.size() + blockSize - 1) / blockSize;
+    for (int b = 0; b < qMin(blocks, blockSamples.size()); ++b) {
+        if (!trajectories.append(blockSamples[b].constData(), blockSamples[b].size())) {
+            storageFull = true;
+            return;
+        }
+    }
+
+    // La partícula nueva va al final, como en recordPositions
+    if (first >= 0) {
+        int i = particles.size() - 1;
+        TrajectorySample sample = { currentStep, particleIds[i], particles.x[i], particles.y[i] };
+        if (!trajectories.append(sample)) {
+            storageFull = true;
         }
     }
 }
@@ -202,9 +987,11 @@ void Simulator::recordPositions()
 {
     // Guardar la posición actual de cada partícula activa
     for (int i = 0; i < particles.size(); ++i) {
-        if (i < trajectories.size()) {
-            if (particles[i].isActive()) {
-                trajectories[i].append(particles[i].getPosition());
+        if (particles.active[i]) {
+            TrajectorySample sample = { currentStep, particleIds[i], particles.x[i], particles.y[i] };
+            if (!trajectories.append(sample)) {
+                storageFull = true;
+                return;
             }
         }
     }
@@ -228,7 +1015,13 @@ void Simulator::exportToFile(const QString& filename)
     out << "# Paso de tiempo (dt): " << dt << " segundos\n";
     out << "# Número de partículas iniciales: " << particles.size() << "\n";
     out << "# Número de obstáculos: " << obstacles.size() << "\n";
-    out << "# Coeficiente de restitución: " << restitutionCoefficient << "\n";
+    for (int j = 0; j < obstacles.size(); ++j) {
+        QRectF r = obstacles[j].getRect();
+        out << "# Obstáculo " << j << ": " << r.x() << ", " << r.y() << ", "
+            << r.width() << ", " << r.height() << "\n";
+    }
+    out << "# Coeficiente de restitución: " << obstacleRestitution() << "\n";
+    out << "# Precisión numérica: " << simPrecisionName() << "\n";
     out << "# ============================================\n\n";
 
     // Escribir trayectorias
@@ -236,55 +1029,43 @@ void Simulator::exportToFile(const QString& filename)
     out << "# Formato: Tiempo(s), Partícula_ID, X, Y\n";
     out << "# ============================================\n";
 
-    for (int i = 0; i < trajectories.size(); ++i) {
-        for (int t = 0; t < trajectories[i].size(); ++t) {
-            double time = t * dt;
-            out << time << ","
-                << i << ","
-                << trajectories[i][t].x() << ","
-                << trajectories[i][t].y() << "\n";
+    // Las muestras se guardan en orden de paso (incluye las volcadas a disco)
+    trajectories.forEachChunk([&](const TrajectorySample* samples, int count) {
+        for (int k = 0; k < count; ++k) {
+            out << samples[k].step * dt << ","
+                << samples[k].particleId << ","
+                << samples[k].x << ","
+                << samples[k].y << "\n";
         }
-    }
+    });
 
-    // Escribir colisiones
+    // Escribir colisiones (los conteos por tipo ya están en las estadísticas)
     out << "\n# COLISIONES\n";
     out << "# Formato: Tiempo(s), Descripción\n";
     out << "# ============================================\n";
 
-    for (const CollisionEvent& event : collisions) {
-        out << event.time << "," << event.description << "\n";
-    }
+    collisions.forEachChunk([&](const CollisionEvent* events, int count) {
+        for (int k = 0; k < count; ++k) {
+            out << events[k].time << "," << events[k].describe() << "\n";
+        }
+    });
+
+    qint64 totalPoints = trajectories.size();
 
     // Escribir resumen final
     out << "\n# ============================================\n";
     out << "# RESUMEN\n";
     out << "# ============================================\n";
-    out << "# Total de puntos de trayectoria registrados: ";
-    int totalPoints = 0;
-    for (const auto& traj : trajectories) {
-        totalPoints += traj.size();
-    }
-    out << totalPoints << "\n";
+    out << "# Total de puntos de trayectoria registrados: " << totalPoints << "\n";
     out << "# Total de colisiones registradas: " << collisions.size() << "\n";
-
-    // Contar tipos de colisiones
-    int wallCollisions = 0;
-    int obstacleCollisions = 0;
-    int fusionCollisions = 0;
-
-    for (const CollisionEvent& event : collisions) {
-        if (event.description.contains("pared")) {
-            wallCollisions++;
-        } else if (event.description.contains("obstáculo")) {
-            obstacleCollisions++;
-        } else if (event.description.contains("fusionan")) {
-            fusionCollisions++;
-        }
+    out << "# Colisiones con paredes: " << statistics.eventCount(WallCollision) << "\n";
+    out << "# Colisiones con obstáculos: " << statistics.eventCount(ObstacleCollision) << "\n";
+    out << "# Fusiones de partículas: " << statistics.eventCount(MergeCollision) << "\n";
+    if (statistics.eventCount(ElasticCollision) > 0) {
+        out << "# Choques elásticos entre partículas: " << statistics.eventCount(ElasticCollision) << "\n";
     }
-
-    out << "# Colisiones con paredes: " << wallCollisions << "\n";
-    out << "# Colisiones con obstáculos: " << obstacleCollisions << "\n";
-    out << "# Fusiones de partículas: " << fusionCollisions << "\n";
+    statistics.writeSummary(out);
+    out << "# Pico de memoria de datos registrados (bytes): " << arena.getPeak() << "\n";
     out << "# ============================================\n";
 
     file.close();
@@ -293,3 +1074,91 @@ void Simulator::exportToFile(const QString& filename)
     qDebug() << "Total de puntos:" << totalPoints;
     qDebug() << "Total de colisiones:" << collisions.size();
 }
+
+bool Simulator::exportBinary(const QString& filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "No se pudo abrir el archivo para escritura:" << filename;
+        return false;
+    }
+
+    BinaryRunHeader header = {};
+    header.magic = binaryRunMagic;
+    header.version = binaryRunVersion;
+    header.realSize = sizeof(SimReal);
+    header.sampleBytes = sizeof(TrajectorySample);
+    header.eventBytes = sizeof(CollisionEvent);
+    header.initialParticles = particles.size();
+    header.boxWidth = box.getWidth();
+    header.boxHeight = box.getHeight();
+    header.dt = dt;
+    header.restitution = obstacleRestitution();
+    header.obstacleCount = obstacles.size();
+    header.sampleCount = trajectories.size();
+    header.eventCount = collisions.size();
+    header.obstaclesOffset = binaryRunAlign(sizeof(header));
+    header.samplesOffset = binaryRunAlign(header.obstaclesOffset + header.obstacleCount * 4 * sizeof(double));
+    header.eventsOffset = binaryRunAlign(header.samplesOffset + header.sampleCount * sizeof(TrajectorySample));
+    header.fileBytes = header.eventsOffset + header.eventCount * sizeof(CollisionEvent);
+
+    // Relleno con ceros hasta el desplazamiento de cada sección
+    bool ok = true;
+    auto writeBytes = [&](const void* data, qint64 bytes) {
+        ok = ok && file.write(static_cast<const char*>(data), bytes) == bytes;
+    };
+    auto padTo = [&](quint64 offset) {
+        static const char zeros[64] = {};
+        writeBytes(zeros, static_cast<qint64>(offset) - file.pos());
+    };
+
+    writeBytes(&header, sizeof(header));
+    padTo(header.obstaclesOffset);
+    for (const Obstacle& obstacle : obstacles) {
+        QRectF r = obstacle.getRect();
+        double rect[4] = { r.x(), r.y(), r.width(), r.height() };
+        writeBytes(rect, sizeof(rect));
+    }
+
+    // Bloques completos de la arena (y los volcados a disco) sin conversión
+    padTo(header.samplesOffset);
+    ok = ok && trajectories.forEachChunk([&](const TrajectorySample* samples, int count) {
+        writeBytes(samples, qint64(count) * sizeof(TrajectorySample));
+    });
+    padTo(header.eventsOffset);
+    ok = ok && collisions.forEachChunk([&](const CollisionEvent* events, int count) {
+        writeBytes(events, qint64(count) * sizeof(CollisionEvent));
+    });
+
+    if (!ok) {
+        qWarning() << "Error al escribir:" << filename << file.errorString();
+    }
+    file.close();
+    return ok;
+}
+
+QString CollisionEvent::describe() const
+{
+    static const char* wallNames[5] = { "", "izquierda", "derecha", "arriba", "abajo" };
+    static const char* sideNames[4] = { "arriba", "derecha", "abajo", "izquierda" };
+
+    switch (kind) {
+    case WallCollision:
+        return QString("Partícula %1 colisiona con pared %2")
+            .arg(particleA).arg(wallNames[side]);
+    case ObstacleCollision:
+        return QString("Partícula %1 colisiona con obstáculo %2 (lado %3)")
+            .arg(particleA).arg(other).arg(sideNames[side]);
+    case ElasticCollision:
+        return QString("Partícula %1 y Partícula %2 chocan (elástico)")
+            .arg(particleA).arg(other);
+    default:
+        return QString("Partícula %1 (masa=%2) y Partícula %3 (masa=%4) se fusionan en nueva partícula %5 (masa=%6)")
+            .arg(particleA)
+            .arg(double(massA), 0, 'f', 2)
+            .arg(other)
+            .arg(double(massB), 0, 'f', 2)
+            .arg(merged)
+            .arg(double(mergedMass), 0, 'f', 2);
+    }
+}
@@ -2,48 +2,330 @@
 #define SIMULATOR_H
 
 #include "particle.h"
+#include "particlestore.h"
+#include "simreal.h"
 #include "obstacle.h"
 #include "box.h"
+#include "collisionkernels.h"
+#include "memoryarena.h"
+#include "chunkedvector.h"
+#include "statestream.h"
+#include "workerpool.h"
+#include "runstatistics.h"
+#include "broadphasegrid.h"
+#include "initialconditions.h"
 #include <QVector>
 #include <QString>
 #include <QTextStream>
+#include <functional>
 
+enum CollisionKind {
+    WallCollision,
+    ObstacleCollision,
+    MergeCollision,
+    ElasticCollision    // choque elástico entre dos partículas
+};
+
+// Evento de colisión de tamaño fijo (se guarda en bloques de la arena).
+// La descripción legible se arma solo al exportar.
 struct CollisionEvent {
     double time;
-    QString description;
+    qint32 kind;        // CollisionKind
+    qint32 side;        // pared 1-4 o lado del obstáculo 0-3
+    qint32 particleA;
+    qint32 other;       // obstáculo o segunda partícula
+    qint32 merged;      // partícula resultante de una fusión
+    SimReal massA;
+    SimReal massB;
+    SimReal mergedMass;
+
+    QString describe() const;
 };
 
+// Punto de trayectoria registrado en un paso
+struct TrajectorySample {
+    qint32 step;
+    qint32 particleId;
+    SimReal x;
+    SimReal y;
+};
+
+// Vista de un paso recién calculado (sin copias): apunta al estado interno
+// del simulador y es válida hasta que se calcule el siguiente paso
+struct StepFrame {
+    int step;                                 // pasos acumulados
+    double time;                              // tiempo al inicio del paso
+    const ParticleStore* particles;
+    const QVector<qint32>* ids;               // ID estable de cada posición
+    const QVector<CollisionEvent>* events;    // eventos de este paso
+    const RunStatistics* statistics;
+};
+
+// Estado que comparten los núcleos especializados del paso (simulator.cpp)
+struct StepContext;
+typedef void (*SweepKernel)(const StepContext&, int, int, QVector<CollisionEvent>&, StepTally&);
+typedef void (*WallKernel)(const StepContext&, int, int, QVector<CollisionEvent>&);
+
 class Simulator
 {
 public:
     Simulator(double boxWidth, double boxHeight, double dt);
+    ~Simulator();
+
+    // Constantes físicas
+    static constexpr SimReal restitutionCoefficient = 0.7;  // para colisiones con obstáculos
 
     void addParticle(const Particle& particle);
     void addObstacle(const Obstacle& obstacle);
 
-    void run(double duration);
+    // Agrega de una vez todas las partículas de un almacén (por ejemplo, de
+    // generateScenario), con IDs consecutivos tras los existentes
+    void addParticles(const ParticleStore& store);
+
+    // Carga masiva desde un archivo binario de condiciones iniciales (ver
+    // initialconditions.h): se mapea el archivo y cada columna se copia de
+    // una vez al almacén. Las partículas se agregan tras las existentes; la
+    // caja del archivo debe coincidir con la del simulador.
+    bool loadInitialConditions(const QString& filename);
+
+    // Escribe partículas (en orden de ID) y obstáculos actuales en el mismo
+    // formato, para reutilizar un escenario generado en muchas corridas
+    bool saveInitialConditions(const QString& filename) const;
+
+    // Qué hacer si los datos registrados exceden el presupuesto de memoria
+    enum MemoryPolicy {
+        FailFast,      // no iniciar (o detener) la corrida
+        SpillToDisk    // volcar los bloques llenos a archivos temporales
+    };
+
+    // Presupuesto en bytes para trayectorias y eventos (0 = sin límite)
+    void setMemoryBudget(qint64 bytes, MemoryPolicy policy = FailFast,
+                         const QString& spillPrefix = "simulacion_volcado");
+
+    // Memoria estimada de los datos a registrar: trayectorias de todos los
+    // pasos más un bloque de eventos (el número de eventos no se conoce antes)
+    qint64 estimateFootprint(double duration) const;
+    qint64 getPeakMemoryUsage() const { return arena.getPeak(); }
+
+    // Publica el estado cada 'everySteps' pasos en un flujo de memoria
+    // compartida (nullptr para desactivar). El flujo no pertenece al simulador.
+    void setStateStream(StateStreamWriter* stream, int everySteps = 1);
+
+    // Hilos para las fases por bloques y la búsqueda de fusiones (1 = serie)
+    void setThreadCount(int threads);
+    int threadCount() const { return pool ? pool->size() : 1; }
+
+    // Modo determinista (por defecto): bloques de tamaño fijo independientes
+    // del número de hilos, eventos concatenados en orden de bloque y
+    // ordenados por (tiempo, tipo, IDs), y la fusión elegida es siempre la
+    // pareja (i, j) lexicográficamente menor. El resultado es idéntico bit a
+    // bit con 1 o N hilos. Sin él, los eventos quedan en el orden en que los
+    // hilos terminan y se fusiona la primera pareja que cualquier hilo halle.
+    void setDeterministic(bool enabled) { deterministic = enabled; }
+    bool isDeterministic() const { return deterministic; }
+
+    // Pasada fusionada (por defecto): cada bloque de partículas se integra,
+    // refleja, prueba contra obstáculos, se asigna a la rejilla y se registra
+    // en un solo recorrido. Sin ella, cada fase recorre todo el arreglo (se
+    // conserva para comparar el tráfico de memoria en el banco de pruebas).
+    void setFusedSweep(bool enabled) { fusedSweep = enabled; }
+    bool isFusedSweep() const { return fusedSweep; }
+
+    // Reordena el almacén de partículas en orden Z (Morton) sobre la caja cada
+    // 'everySteps' pasos (0 = nunca), para que las vecinas queden contiguas en
+    // memoria. Trayectorias, eventos y fusiones usan IDs estables: la
+    // posición i de getParticles() corresponde al ID getParticleIds()[i].
+    void setReorderInterval(int everySteps) { reorderEvery = qMax(0, everySteps); }
+    int reorderInterval() const { return reorderEvery; }
+    const QVector<qint32>& getParticleIds() const { return particleIds; }
+
+    // Rejilla jerárquica (por defecto): el nivel fino se ajusta al radio
+    // mínimo y cada partícula va al nivel de su radio (ver broadphasegrid.h).
+    // Sin ella, un solo nivel con celdas >= 2 * radio máximo. Las parejas
+    // halladas son las mismas; cambia solo cuántas se prueban.
+    void setHierarchicalGrid(bool enabled) { hierarchicalGrid = enabled; }
+    bool isHierarchicalGrid() const { return hierarchicalGrid; }
+    int gridLevels() const { return grid.levelCount(); }
+
+    // Políticas de la física del paso. prepareRun elige para la combinación
+    // un núcleo instanciado de plantillas (paredes x obstáculos x registro x
+    // rejilla), así que el bucle por partícula no consulta la configuración
+    // ni tiene ramas por política. Por defecto: el comportamiento original.
+    enum BoundaryPolicy {
+        ReflectWalls,     // rebote elástico (evento por pared)
+        PeriodicWalls,    // reaparece por el lado opuesto, sin evento; las parejas
+                          // se buscan y se miden también a través del borde
+        AbsorbWalls       // la partícula se desactiva al tocar la pared (evento)
+    };
+    enum PairPolicy {
+        MergePairs,       // una fusión por paso, la pareja de menor ID
+        ElasticPairs,     // todas las parejas en contacto que se acercan rebotan
+        IgnorePairs       // sin rejilla ni búsqueda de parejas
+    };
+    enum ObstaclePolicy {
+        InelasticObstacles,   // rebote con restitutionCoefficient
+        ElasticObstacles,     // rebote con restitución 1
+        IgnoreObstacles       // los obstáculos no se prueban
+    };
+
+    void setBoundaryPolicy(BoundaryPolicy policy) { boundaryPolicy = policy; }
+    void setPairPolicy(PairPolicy policy) { pairPolicy = policy; }
+    void setObstaclePolicy(ObstaclePolicy policy) { obstaclePolicy = policy; }
+    BoundaryPolicy getBoundaryPolicy() const { return boundaryPolicy; }
+    PairPolicy getPairPolicy() const { return pairPolicy; }
+    ObstaclePolicy getObstaclePolicy() const { return obstaclePolicy; }
+    SimReal obstacleRestitution() const
+    {
+        return obstaclePolicy == ElasticObstacles ? SimReal(1) : restitutionCoefficient;
+    }
+
+    // Estadísticas acumuladas en el bucle de pasos; opcionalmente se escriben
+    // como serie de tiempo CSV cada 'everySteps' pasos
+    bool setStatisticsOutput(const QString& filename, int everySteps = 1);
+    const RunStatistics& getStatistics() const { return statistics; }
+
+    // Sin trayectorias solo se guardan eventos y estadísticas
+    void setRecordTrajectories(bool enabled) { recordTrajectories = enabled; }
+    bool isRecordingTrajectories() const { return recordTrajectories; }
+
+    bool run(double duration);
+
+    // Corrida paso a paso como rango:
+    //
+    //   for (const StepFrame& frame : sim.steps(20.0)) {
+    //       if (frame.events->isEmpty()) continue;
+    //       ...
+    //       if (listo) break;   // el simulador queda en ese paso
+    //   }
+    //
+    // begin() valida el presupuesto y calcula el primer paso; cada ++ calcula
+    // uno más. Si la memoria se agota, el rango termina antes (storageExhausted).
+    class StepRange
+    {
+    public:
+        class iterator
+        {
+        public:
+            iterator(Simulator* sim, int remaining) : sim(sim), remaining(remaining) {}
+            const StepFrame& operator*() const { return sim->frame; }
+            const StepFrame* operator->() const { return &sim->frame; }
+            iterator& operator++();
+            bool operator!=(const iterator& other) const { return remaining != other.remaining; }
+            bool operator==(const iterator& other) const { return remaining == other.remaining; }
+
+        private:
+            Simulator* sim;
+            int remaining;   // pasos por calcular incluyendo el actual; 0 = fin
+        };
+
+        StepRange(Simulator* sim, double duration) : sim(sim), duration(duration) {}
+        iterator begin();
+        iterator end() { return iterator(sim, 0); }
+
+    private:
+        Simulator* sim;
+        double duration;
+    };
+
+    StepRange steps(double duration) { return StepRange(this, duration); }
+    bool storageExhausted() const { return storageFull; }
     void exportToFile(const QString& filename);
 
+    // Misma corrida en binario para el análisis fuera de línea (binaryexport.h)
+    bool exportBinary(const QString& filename);
+
+    const ParticleStore& getParticles() const { return particles; }
+    double getCurrentTime() const { return currentTime; }
+    qint64 getCollisionCount() const { return collisions.size(); }
+    const ChunkedVector<CollisionEvent>& getCollisions() const { return collisions; }
+    const ChunkedVector<TrajectorySample>& getTrajectories() const { return trajectories; }
+
 private:
     Box box;
-    QVector<Particle> particles;
+    ParticleStore particles;
     QVector<Obstacle> obstacles;
+    RectPack<SimReal> obstacleRects;  // copia empaquetada para el núcleo por lotes
     double dt;  // intervalo de tiempo
     double currentTime;
+    int currentStep;   // pasos acumulados entre corridas
 
-    // Datos de simulación
-    QVector<QVector<QPointF>> trajectories;  // trayectorias[particleId][timeStep]
-    QVector<CollisionEvent> collisions;
+    // Datos de simulación, en bloques fijos de la arena (sin realocar)
+    MemoryArena arena;
+    MemoryPolicy memoryPolicy;
+    bool storageFull;
+    ChunkedVector<TrajectorySample> trajectories;  // en orden de paso
+    ChunkedVector<CollisionEvent> collisions;
 
-    // Constantes físicas
-    const double restitutionCoefficient = 0.7;  // para colisiones con obstáculos
+    void recordEvent(const CollisionEvent& event);
+
+    // Estadísticas en línea: una suma parcial por bloque y paso
+    RunStatistics statistics;
+    QVector<StepTally> blockTallies;
+    bool recordTrajectories;
+
+    // Flujo de estado en vivo para visores externos
+    StateStreamWriter* stateStream;
+    int streamInterval;
+
+    // Ejecución en paralelo por bloques
+    static const int blockSize = 2048;
+    WorkerPool* pool;
+    bool deterministic;
+    QVector<QVector<CollisionEvent>> eventBuffers;
+    QVector<CollisionEvent> stepEvents;    // eventos del paso en curso
+
+    // Rejilla de la búsqueda de parejas, entre el radio mínimo y el máximo
+    SimReal minRadius;
+    SimReal maxRadius;
+    bool hierarchicalGrid;
+    BroadphaseGrid grid;
+    QVector<qint32> cellOf;
+    bool fusedSweep;
+    QVector<QVector<TrajectorySample>> blockSamples;   // muestras del paso por bloque
 
-    void updateParticles();
-    void handleWallCollisions();
-    void handleObstacleCollisions();
-    void handleParticleCollisions();
+    // IDs estables frente al reordenamiento espacial
+    QVector<qint32> particleIds;   // posición -> ID
+    QVector<qint32> slotOf;        // ID -> posición
+    int reorderEvery;
+    bool reordered;                // false mientras posición == ID
+    void registerParticles(int first);
+    void reorderParticles();
 
+    // Caché de contactos partícula-obstáculo (por posición, como el almacén):
+    // un contacto que sigue en el paso siguiente no vuelve a rebotar ni a
+    // registrar evento
+    QVector<qint32> obstacleContact;
+
+    // Políticas y núcleos elegidos para ellas por selectKernels
+    BoundaryPolicy boundaryPolicy;
+    PairPolicy pairPolicy;
+    ObstaclePolicy obstaclePolicy;
+    SweepKernel sweepPass;
+    WallKernel wallPass;
+    SweepKernel obstaclePass;
+    QVector<QVector<quint64>> pairBuffers;   // parejas elásticas por hilo
+    void selectKernels();
+    StepContext stepContext();
+
+    void runBlocks(const std::function<void(int, int, QVector<CollisionEvent>&)>& phase);
+    bool findMergePair(int& first, int& second) const;
+    static bool eventOrder(const CollisionEvent& a, const CollisionEvent& b);
+
+    void sweepBlock(int begin, int end, QVector<CollisionEvent>& out, StepTally& tally);
+    void updateParticles(int begin, int end, StepTally& tally);
+    void handleWallCollisions(int begin, int end, QVector<CollisionEvent>& out);
+    void handleObstacleCollisions(int begin, int end, QVector<CollisionEvent>& out, StepTally& tally);
+    void binParticles(int begin, int end);
+    void handleParticleCollisions(int& first, int& second);
+    void handleElasticCollisions();
+
+    void flushSamples(int first, int second);
     void recordPositions();
+
+    // Un paso completo de la corrida (lo usan run y StepRange)
+    bool prepareRun(double duration);
+    bool advance();
+    StepFrame frame;
 };
 
 #endif // SIMULATOR_H
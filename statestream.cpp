@@ -0,0 +1,243 @@
+#include "statestream.h"
+#include <QDebug>
+#include <QTextStream>
+#include <QThread>
+#include <cstring>
+#include <new>
+
+namespace {
+
+const quint32 streamMagic = 0x50355353;   // 'P5SS'
+const quint32 streamVersion = 1;
+
+quint64 align64(quint64 bytes)
+{
+    return (bytes + 63) & ~quint64(63);
+}
+
+// Desplazamientos de los arreglos dentro de una ranura
+struct SlotLayout
+{
+    quint64 x, y, radius, active, total;
+
+    explicit SlotLayout(quint64 capacity)
+    {
+        quint64 column = align64(capacity * sizeof(SimReal));
+        x = align64(sizeof(StreamSlotHeader));
+        y = x + column;
+        radius = y + column;
+        active = radius + column;
+        total = align64(active + capacity);
+    }
+};
+
+} // namespace
+
+StateStreamWriter::StateStreamWriter(const QString& name, int cap, int ringSlots)
+    : capacity(cap), slotCount(qMax(2, ringSlots)), slotBytes(0),
+    header(nullptr), slotBase(nullptr), frameCounter(0)
+{
+    memory.setNativeKey(name);
+}
+
+StateStreamWriter::~StateStreamWriter()
+{
+    close();
+}
+
+bool StateStreamWriter::open(double boxWidth, double boxHeight)
+{
+    SlotLayout layout(capacity);
+    slotBytes = layout.total;
+    quint64 slotsOffset = align64(sizeof(StreamHeader));
+    quint64 totalBytes = slotsOffset + slotBytes * slotCount;
+
+    if (!memory.create(static_cast<qint64>(totalBytes))) {
+        // Segmento huérfano de una corrida anterior: adjuntar y soltar
+        if (memory.attach()) memory.detach();
+        if (!memory.create(static_cast<qint64>(totalBytes))) {
+            qWarning() << "No se pudo crear la memoria compartida:" << memory.errorString();
+            return false;
+        }
+    }
+
+    char* base = static_cast<char*>(memory.data());
+    std::memset(base, 0, totalBytes);
+
+    header = new (base) StreamHeader;
+    header->magic = streamMagic;
+    header->version = streamVersion;
+    header->slotCount = slotCount;
+    header->capacity = capacity;
+    header->realSize = sizeof(SimReal);
+    header->reserved = 0;
+    header->slotBytes = slotBytes;
+    header->slotsOffset = slotsOffset;
+    header->boxWidth = boxWidth;
+    header->boxHeight = boxHeight;
+    header->latestFrame.store(0, std::memory_order_relaxed);
+
+    slotBase = base + slotsOffset;
+    for (int s = 0; s < slotCount; ++s) {
+        StreamSlotHeader* slot = new (slotBase + s * slotBytes) StreamSlotHeader;
+        slot->sequence.store(0, std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+}
+
+void StateStreamWriter::close()
+{
+    if (memory.isAttached()) memory.detach();
+    header = nullptr;
+    slotBase = nullptr;
+}
+
+void StateStreamWriter::publish(int step, double time, qint64 collisionCount,
+                                const ParticleStore& particles)
+{
+    if (!header) return;
+
+    quint64 frame = ++frameCounter;
+    char* base = slotBase + (frame % slotCount) * slotBytes;
+    StreamSlotHeader* slot = reinterpret_cast<StreamSlotHeader*>(base);
+    SlotLayout layout(capacity);
+
+    // Secuencia impar: cuadro en escritura
+    quint64 seq = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    int count = qMin(particles.size(), capacity);
+    slot->frame = frame;
+    slot->step = step;
+    slot->count = count;
+    slot->time = time;
+    slot->collisionCount = collisionCount;
+    slot->truncated = particles.size() > capacity ? 1 : 0;
+
+    std::memcpy(base + layout.x, particles.x.constData(), count * sizeof(SimReal));
+    std::memcpy(base + layout.y, particles.y.constData(), count * sizeof(SimReal));
+    std::memcpy(base + layout.radius, particles.radius.constData(), count * sizeof(SimReal));
+    std::memcpy(base + layout.active, particles.active.constData(), count);
+
+    // Secuencia par: cuadro completo y visible
+    slot->sequence.store(seq + 2, std::memory_order_release);
+    header->latestFrame.store(frame, std::memory_order_release);
+}
+
+StateStreamReader::StateStreamReader()
+    : header(nullptr), slotBase(nullptr)
+{
+}
+
+bool StateStreamReader::attach(const QString& name)
+{
+    memory.setNativeKey(name);
+    if (!memory.attach(QSharedMemory::ReadOnly)) return false;
+
+    const char* base = static_cast<const char*>(memory.constData());
+    const StreamHeader* h = reinterpret_cast<const StreamHeader*>(base);
+    if (h->magic != streamMagic || h->version != streamVersion || h->realSize != sizeof(SimReal)) {
+        qWarning() << "Flujo de estado incompatible:" << name;
+        memory.detach();
+        return false;
+    }
+
+    header = h;
+    slotBase = base + h->slotsOffset;
+    return true;
+}
+
+void StateStreamReader::detach()
+{
+    if (memory.isAttached()) memory.detach();
+    header = nullptr;
+    slotBase = nullptr;
+}
+
+bool StateStreamReader::latest(StateFrameView& view) const
+{
+    if (!header) return false;
+
+    quint64 frame = header->latestFrame.load(std::memory_order_acquire);
+    if (frame == 0) return false;
+
+    const char* base = slotBase + (frame % header->slotCount) * header->slotBytes;
+    const StreamSlotHeader* slot = reinterpret_cast<const StreamSlotHeader*>(base);
+
+    quint64 seq = slot->sequence.load(std::memory_order_acquire);
+    if (seq & 1) return false;   // el escritor ya está reutilizando la ranura
+
+    SlotLayout layout(header->capacity);
+    view.frame = slot->frame;
+    view.step = slot->step;
+    view.time = slot->time;
+    view.count = slot->count;
+    view.collisionCount = slot->collisionCount;
+    view.x = reinterpret_cast<const SimReal*>(base + layout.x);
+    view.y = reinterpret_cast<const SimReal*>(base + layout.y);
+    view.radius = reinterpret_cast<const SimReal*>(base + layout.radius);
+    view.active = reinterpret_cast<const quint8*>(base + layout.active);
+    view.sequence = seq;
+    view.slot = slot;
+
+    return isValid(view);
+}
+
+bool StateStreamReader::isValid(const StateFrameView& view) const
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return view.slot->sequence.load(std::memory_order_relaxed) == view.sequence;
+}
+
+int watchStateStream(const QString& name)
+{
+    StateStreamReader reader;
+    QTextStream out(stdout);
+
+    // Esperar a que el simulador cree el segmento
+    int attempts = 0;
+    while (!reader.attach(name)) {
+        if (++attempts > 50) {
+            qWarning() << "No se encontró el flujo de estado" << name;
+            return 1;
+        }
+        QThread::msleep(100);
+    }
+
+    quint64 lastFrame = 0;
+    int idle = 0;
+    while (idle < 50) {
+        StateFrameView view;
+        if (reader.latest(view) && view.frame != lastFrame) {
+            int activeCount = 0;
+            double sumX = 0.0, sumY = 0.0;
+            for (int i = 0; i < view.count; ++i) {
+                if (!view.active[i]) continue;
+                activeCount++;
+                sumX += view.x[i];
+                sumY += view.y[i];
+            }
+
+            // Descartar el resumen si la ranura se sobrescribió a mitad
+            if (reader.isValid(view)) {
+                out << "cuadro=" << view.frame << " t=" << view.time
+                    << " activas=" << activeCount
+                    << " centro=(" << (activeCount ? sumX / activeCount : 0.0) << ","
+                    << (activeCount ? sumY / activeCount : 0.0) << ")"
+                    << " colisiones=" << view.collisionCount << "\n";
+                out.flush();
+                lastFrame = view.frame;
+                idle = 0;
+            }
+        } else {
+            idle++;
+        }
+        QThread::msleep(100);
+    }
+
+    reader.detach();
+    return 0;
+}
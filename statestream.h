@@ -0,0 +1,121 @@
+#ifndef STATESTREAM_H
+#define STATESTREAM_H
+
+#include "particlestore.h"
+#include "simreal.h"
+#include <QSharedMemory>
+#include <QString>
+#include <atomic>
+
+// Flujo del estado del simulador en memoria compartida.
+//
+// El simulador escribe cada cuadro en un anillo de ranuras; cada ranura
+// tiene un contador de secuencia (seqlock): impar mientras se escribe, par
+// cuando el cuadro está completo. Los lectores nunca toman un candado: leen
+// el último cuadro directamente de la memoria compartida y al terminar
+// comprueban que la secuencia no cambió. El escritor nunca espera.
+//
+// Distribución (alineada a 64 bytes), para visores que no usan Qt:
+//   StreamHeader
+//   ranura 0: StreamSlotHeader, x[capacity], y[capacity], radius[capacity]
+//             (SimReal, tamaño en realSize), active[capacity] (uint8)
+//   ranura 1 ... ranura slotCount-1, cada una de slotBytes bytes
+// En Linux el segmento es POSIX (/dev/shm) con la clave nativa indicada.
+
+struct StreamHeader
+{
+    quint32 magic;          // 'P5SS'
+    quint32 version;
+    quint32 slotCount;
+    quint32 capacity;       // máximo de partículas por cuadro
+    quint32 realSize;       // sizeof(SimReal) del escritor
+    quint32 reserved;
+    quint64 slotBytes;
+    quint64 slotsOffset;
+    double boxWidth;
+    double boxHeight;
+    std::atomic<quint64> latestFrame;   // 0 = aún no hay cuadros
+};
+
+struct StreamSlotHeader
+{
+    std::atomic<quint64> sequence;
+    quint64 frame;
+    qint32 step;
+    qint32 count;           // partículas en el cuadro (<= capacity)
+    double time;
+    qint64 collisionCount;
+    qint32 truncated;       // 1 si había más partículas que capacidad
+    qint32 reserved;
+};
+
+// Vista sin copia de un cuadro dentro de la memoria compartida
+struct StateFrameView
+{
+    quint64 frame;
+    int step;
+    double time;
+    int count;
+    qint64 collisionCount;
+    const SimReal* x;
+    const SimReal* y;
+    const SimReal* radius;
+    const quint8* active;
+
+    quint64 sequence;       // para validar la lectura con StateStreamReader::isValid
+    const StreamSlotHeader* slot;
+};
+
+class StateStreamWriter
+{
+public:
+    StateStreamWriter(const QString& name, int capacity, int slotCount = 4);
+    ~StateStreamWriter();
+
+    bool open(double boxWidth, double boxHeight);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    void publish(int step, double time, qint64 collisionCount, const ParticleStore& particles);
+
+private:
+    QSharedMemory memory;
+    int capacity;
+    int slotCount;
+    quint64 slotBytes;
+    StreamHeader* header;
+    char* slotBase;
+    quint64 frameCounter;
+
+    StateStreamWriter(const StateStreamWriter&);
+    StateStreamWriter& operator=(const StateStreamWriter&);
+};
+
+class StateStreamReader
+{
+public:
+    StateStreamReader();
+
+    bool attach(const QString& name);
+    void detach();
+    bool isAttached() const { return header != nullptr; }
+
+    // Último cuadro completo; false si no hay o si se está escribiendo
+    bool latest(StateFrameView& view) const;
+
+    // true si el cuadro no fue sobrescrito mientras se leía
+    bool isValid(const StateFrameView& view) const;
+
+    double boxWidth() const { return header ? header->boxWidth : 0.0; }
+    double boxHeight() const { return header ? header->boxHeight : 0.0; }
+
+private:
+    QSharedMemory memory;
+    const StreamHeader* header;
+    const char* slotBase;
+};
+
+// Visor de consola: imprime el último cuadro periódicamente (modo --watch)
+int watchStateStream(const QString& name);
+
+#endif // STATESTREAM_H
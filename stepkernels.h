@@ -0,0 +1,188 @@
+#ifndef STEPKERNELS_H
+#define STEPKERNELS_H
+
+#include "simulator.h"
+#include "collisionkernels.h"
+#include "particlestore.h"
+#include <QVector>
+#include <cmath>
+
+// Física por partícula del paso de tiempo: movimiento, políticas de paredes
+// y de obstáculos. La instancian los núcleos de Simulator y los mosaicos de
+// DomainDecomposition, así que ambos resuelven cada partícula igual.
+
+// Punteros crudos a las columnas del almacén para los bucles por bloque
+struct ParticleColumns {
+    SimReal* x;
+    SimReal* y;
+    SimReal* vx;
+    SimReal* vy;
+    const SimReal* mass;
+    const SimReal* radius;
+    quint8* active;            // escribible: la política de paredes puede absorber
+    const qint32* id;          // ID estable de cada posición
+    qint32* contact;           // obstáculo tocado en el paso anterior (-1 = ninguno)
+
+    ParticleColumns(ParticleStore& p, const QVector<qint32>& ids, QVector<qint32>& contacts)
+        : x(p.x.data()), y(p.y.data()), vx(p.vx.data()), vy(p.vy.data()),
+          mass(p.mass.constData()), radius(p.radius.constData()), active(p.active.data()),
+          id(ids.constData()), contact(contacts.data())
+    {
+    }
+};
+
+// Respuesta de una partícula activa: la comparten la pasada fusionada y las
+// pasadas separadas por fase
+
+inline void integrateOne(const ParticleColumns& p, int i, SimReal h, StepTally& tally)
+{
+    SimReal vx = p.vx[i];
+    SimReal vy = p.vy[i];
+    p.x[i] += vx * h;
+    p.y[i] += vy * h;
+    tally.path += std::sqrt(double(vx) * vx + double(vy) * vy) * h;
+}
+
+inline void logWall(const ParticleColumns& p, int i, int wall, double time,
+                    QVector<CollisionEvent>& out)
+{
+    // Registrar evento de colisión
+    CollisionEvent event = {};
+    event.time = time;
+    event.kind = WallCollision;
+    event.side = wall;
+    event.particleA = p.id[i];
+    out.append(event);
+}
+
+// Políticas de paredes. apply() retorna el código de
+// Box::checkWallCollision (1-4, solo la primera pared que toca) o 0; las
+// comparaciones se combinan con selecciones en lugar de ramas.
+
+struct ReflectBoundary
+{
+    static const bool absorbs = false;
+
+    static int apply(const ParticleColumns& p, int i, SimReal width, SimReal height)
+    {
+        const SimReal x = p.x[i];
+        const SimReal y = p.y[i];
+        const SimReal r = p.radius[i];
+        const bool left = x - r <= 0;
+        const bool right = !left & (x + r >= width);
+        const bool top = !(left | right) & (y - r <= 0);
+        const bool bottom = !(left | right | top) & (y + r >= height);
+
+        // Colisiones perfectamente elásticas con las paredes
+        p.x[i] = left ? r : (right ? width - r : x);
+        p.y[i] = top ? r : (bottom ? height - r : y);
+        p.vx[i] = (left | right) ? -p.vx[i] : p.vx[i];
+        p.vy[i] = (top | bottom) ? -p.vy[i] : p.vy[i];
+        return left * 1 + right * 2 + top * 3 + bottom * 4;
+    }
+};
+
+struct PeriodicBoundary
+{
+    static const bool absorbs = false;
+
+    // El centro sale por un lado y entra por el opuesto (a lo más una caja
+    // por paso); no hay evento
+    static int apply(const ParticleColumns& p, int i, SimReal width, SimReal height)
+    {
+        const SimReal x = p.x[i];
+        const SimReal y = p.y[i];
+        p.x[i] = x + (x < 0 ? width : SimReal(0)) - (x >= width ? width : SimReal(0));
+        p.y[i] = y + (y < 0 ? height : SimReal(0)) - (y >= height ? height : SimReal(0));
+        return 0;
+    }
+};
+
+struct AbsorbBoundary
+{
+    static const bool absorbs = true;
+
+    // La partícula que toca una pared se desactiva donde está
+    static int apply(const ParticleColumns& p, int i, SimReal width, SimReal height)
+    {
+        const SimReal x = p.x[i];
+        const SimReal y = p.y[i];
+        const SimReal r = p.radius[i];
+        const bool left = x - r <= 0;
+        const bool right = !left & (x + r >= width);
+        const bool top = !(left | right) & (y - r <= 0);
+        const bool bottom = !(left | right | top) & (y + r >= height);
+        const int wall = left * 1 + right * 2 + top * 3 + bottom * 4;
+        p.active[i] = quint8(wall == 0);
+        return wall;
+    }
+};
+
+// Políticas de obstáculos: si se prueban y con qué restitución
+
+struct InelasticResponse
+{
+    static const bool enabled = true;
+    static SimReal restitution() { return Simulator::restitutionCoefficient; }
+};
+
+struct ElasticResponse
+{
+    static const bool enabled = true;
+    static SimReal restitution() { return SimReal(1); }
+};
+
+struct NoResponse
+{
+    static const bool enabled = false;
+    static SimReal restitution() { return SimReal(1); }
+};
+
+template <class Obstacles>
+inline void collideWithObstacles(const ParticleColumns& p, int i, const RectPack<SimReal>& rects,
+                                 double time, QVector<CollisionEvent>& out, StepTally& tally)
+{
+    if (!Obstacles::enabled) return;
+
+    // Un círculo contra todos los obstáculos empaquetados; solo se
+    // procesa la primera colisión por partícula por paso de tiempo
+    int side = 0;
+    int j = firstCircleRectHit(p.x[i], p.y[i], p.radius[i], rects, &side);
+    if (j < 0) {
+        p.contact[i] = -1;
+        return;
+    }
+
+    // La partícula sale del obstáculo; rebota (v'⊥ = -ε v⊥, v'∥ = v∥) si se
+    // acercaba al lado, con evento solo al iniciar el contacto
+    double before = double(p.vx[i]) * p.vx[i] + double(p.vy[i]) * p.vy[i];
+    bool started = resolveRectContact(p.x[i], p.y[i], p.vx[i], p.vy[i], p.radius[i], rects, j,
+                                      side, Obstacles::restitution(), p.contact[i]);
+    double after = double(p.vx[i]) * p.vx[i] + double(p.vy[i]) * p.vy[i];
+    tally.restitutionLoss += 0.5 * p.mass[i] * (before - after);
+
+    if (started) {
+        // Registrar evento de colisión
+        CollisionEvent event = {};
+        event.time = time;
+        event.kind = ObstacleCollision;
+        event.side = side;
+        event.particleA = p.id[i];
+        event.other = j;
+        out.append(event);
+    }
+}
+
+// Última respuesta del paso por partícula: momento y energía finales
+inline void tallyParticle(const ParticleColumns& p, int i, StepTally& tally)
+{
+    double m = p.mass[i];
+    double vx = p.vx[i];
+    double vy = p.vy[i];
+    tally.momentumX += m * vx;
+    tally.momentumY += m * vy;
+    tally.kinetic += 0.5 * m * (vx * vx + vy * vy);
+    tally.active++;
+}
+
+#endif // STEPKERNELS_H
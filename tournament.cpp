@@ -0,0 +1,321 @@
+#include "tournament.h"
+#include "workerpool.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QDebug>
+#include <atomic>
+#include <cmath>
+#include <random>
+
+namespace {
+
+const double boxWidth = 800;
+const double boxHeight = 600;
+
+// Rango de los deslizadores de MainWindow
+const int minAngle = 0;
+const int maxAngle = 90;
+const int minSpeed = 50;
+const int maxSpeed = 300;
+
+// Tiros al azar que evalúa la estrategia apuntada
+const int aimedCandidates = 8;
+
+// Partidas que toma un hilo de una vez
+const int gamesPerClaim = 64;
+
+QString optionValue(const QStringList& args, const QString& name, const QString& fallback)
+{
+    for (int i = 0; i + 1 < args.size(); ++i) {
+        if (args[i] == name) return args[i + 1];
+    }
+    return fallback;
+}
+
+// El jugador 2 recibe el mapa del jugador 1 reflejado en x
+void addMirrored(TournamentConfig& config, double x, double y, double w, double h, double resistance)
+{
+    config.player1.append(Infrastructure(x, y, w, h, resistance));
+    config.player2.append(Infrastructure(boxWidth - x - w, y, w, h, resistance));
+}
+
+void chooseShot(const GameEngine& engine, ShotStrategy strategy, int ownTurn,
+                std::mt19937& rng, double& angle, double& speed)
+{
+    std::uniform_int_distribution<int> angles(minAngle, maxAngle);
+    std::uniform_int_distribution<int> speeds(minSpeed, maxSpeed);
+
+    switch (strategy) {
+    case RandomStrategy:
+        angle = angles(rng);
+        speed = speeds(rng);
+        break;
+
+    case SweepStrategy:
+        // Pasos primos respecto a los rangos: recorre todas las combinaciones
+        angle = 10 + (ownTurn * 17) % 71;
+        speed = 80 + (ownTurn * 53) % 221;
+        break;
+
+    case AimedStrategy: {
+        // El candidato que más estructuras destruye (y luego golpea)
+        TrajectoryPreview preview;
+        int bestDestroyed = -1;
+        int bestHit = -1;
+        for (int k = 0; k < aimedCandidates; ++k) {
+            double a = angles(rng);
+            double s = speeds(rng);
+            engine.predictTrajectory(engine.getCurrentPlayer(), a, s, Tournament::frameStep, preview);
+            if (preview.blocksDestroyed > bestDestroyed
+                || (preview.blocksDestroyed == bestDestroyed && preview.blocksHit > bestHit)) {
+                bestDestroyed = preview.blocksDestroyed;
+                bestHit = preview.blocksHit;
+                angle = a;
+                speed = s;
+            }
+        }
+        break;
+    }
+    }
+}
+
+} // namespace
+
+Tournament::Tournament()
+    : gamesPerMatchup(1000), maxTurns(200), seed(12345), threadCount(1), elapsed(0.0)
+{
+}
+
+QString Tournament::strategyName(ShotStrategy strategy)
+{
+    switch (strategy) {
+    case RandomStrategy: return "random";
+    case SweepStrategy: return "sweep";
+    case AimedStrategy: return "aimed";
+    }
+    return QString();
+}
+
+bool Tournament::builtInLayout(const QString& name, TournamentConfig& config)
+{
+    config.layout = name;
+    config.player1.clear();
+    config.player2.clear();
+
+    if (name == "clasico") {
+        // El mapa de MainWindow::setupGame
+        addMirrored(config, 50, 450, 40, 100, 200);
+        addMirrored(config, 100, 450, 40, 100, 200);
+        addMirrored(config, 150, 450, 40, 100, 100);
+    } else if (name == "muro") {
+        // Muro de 4 x 6 ladrillos frente al lanzador
+        for (int col = 0; col < 4; ++col) {
+            for (int row = 0; row < 6; ++row) {
+                addMirrored(config, 120 + col * 20, 430 + row * 20, 20, 20, 50);
+            }
+        }
+    } else if (name == "torres") {
+        // Tres torres altas y resistentes
+        addMirrored(config, 80, 350, 30, 200, 250);
+        addMirrored(config, 150, 350, 30, 200, 250);
+        addMirrored(config, 220, 350, 30, 200, 250);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void Tournament::run()
+{
+    matchups.clear();
+    for (int c = 0; c < configs.size(); ++c) {
+        for (ShotStrategy first : strategies) {
+            for (ShotStrategy second : strategies) {
+                MatchupResult m = {};
+                m.config = c;
+                m.first = first;
+                m.second = second;
+                matchups.append(m);
+            }
+        }
+    }
+
+    // Parciales por hilo; las partidas se toman en grupos de un contador común
+    WorkerPool pool(threadCount);
+    QVector<QVector<MatchupResult>> partials(pool.size());
+    for (int t = 0; t < pool.size(); ++t) {
+        partials[t] = matchups;
+    }
+
+    const qint64 total = qint64(matchups.size()) * gamesPerMatchup;
+    std::atomic<qint64> next(0);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    pool.run([&](int worker) {
+        QVector<MatchupResult>& mine = partials[worker];
+        qint64 begin;
+        while ((begin = next.fetch_add(gamesPerClaim)) < total) {
+            qint64 end = qMin(total, begin + gamesPerClaim);
+            for (qint64 g = begin; g < end; ++g) {
+                int m = static_cast<int>(g / gamesPerMatchup);
+                playGame(m, g % gamesPerMatchup, mine[m]);
+            }
+        }
+    });
+
+    elapsed = timer.nsecsElapsed() / 1.0e9;
+
+    for (int t = 0; t < partials.size(); ++t) {
+        for (int m = 0; m < matchups.size(); ++m) {
+            const MatchupResult& p = partials[t][m];
+            MatchupResult& r = matchups[m];
+            r.games += p.games;
+            r.turns += p.turns;
+            for (int k = 0; k < 3; ++k) r.outcomes[k] += p.outcomes[k];
+            for (int k = 0; k < 2; ++k) {
+                r.shots[k] += p.shots[k];
+                r.damageMilli[k] += p.damageMilli[k];
+            }
+            for (int k = 0; k < damageBins; ++k) r.damageHistogram[k] += p.damageHistogram[k];
+        }
+    }
+}
+
+void Tournament::playGame(int matchup, qint64 game, MatchupResult& tally) const
+{
+    const MatchupResult& m = matchups[matchup];
+    const TournamentConfig& config = configs[m.config];
+
+    GameEngine engine(boxWidth, boxHeight);
+    engine.setDamageFactor(config.damageFactor);
+    engine.setRestitutionCoefficient(config.restitutionCoefficient);
+    engine.setDebrisEnabled(false);
+    for (const Infrastructure& infra : config.player1) engine.addInfrastructure(1, infra);
+    for (const Infrastructure& infra : config.player2) engine.addInfrastructure(2, infra);
+
+    std::seed_seq sequence = { seed, static_cast<unsigned int>(matchup),
+                               static_cast<unsigned int>(game),
+                               static_cast<unsigned int>(game >> 32) };
+    std::mt19937 rng(sequence);
+
+    int turn = 0;
+    while (!engine.isGameOver() && turn < maxTurns) {
+        int player = engine.getCurrentPlayer();
+        ShotStrategy strategy = (player == 1) ? m.first : m.second;
+
+        double angle = 45;
+        double speed = 150;
+        chooseShot(engine, strategy, turn / 2, rng, angle, speed);
+
+        double dealt = engine.playShot(angle, speed, frameStep);
+
+        tally.shots[player - 1]++;
+        tally.damageMilli[player - 1] += std::llround(dealt * 1000.0);
+        int bin = static_cast<int>(dealt / damageBinWidth);
+        tally.damageHistogram[qBound(0, bin, damageBins - 1)]++;
+        turn++;
+    }
+
+    tally.games++;
+    tally.turns += turn;
+    tally.outcomes[engine.isGameOver() ? engine.getWinner() : 0]++;
+}
+
+qint64 Tournament::gamesPlayed() const
+{
+    qint64 games = 0;
+    for (const MatchupResult& m : matchups) games += m.games;
+    return games;
+}
+
+void Tournament::writeReport(QTextStream& out) const
+{
+    qint64 games = gamesPlayed();
+    out << "# Torneo de autojuego: " << games << " partidas en " << elapsed << " s ("
+        << (elapsed > 0 ? games / elapsed : 0.0) << " partidas/s), "
+        << threadCount << " hilos, semilla " << seed << ", límite " << maxTurns << " turnos\n";
+    out << "# Formato: Mapa, Factor_daño, Restitución, Estrategia_J1, Estrategia_J2, Partidas, "
+           "Victorias_J1(%), Victorias_J2(%), Empates(%), Turnos_medios, "
+           "Daño_por_disparo_J1, Daño_por_disparo_J2, Histograma_daño_por_disparo[desde:cantidad]\n";
+
+    for (const MatchupResult& m : matchups) {
+        const TournamentConfig& config = configs[m.config];
+        double n = qMax<qint64>(1, m.games);
+
+        out << config.layout << "," << config.damageFactor << "," << config.restitutionCoefficient << ","
+            << strategyName(m.first) << "," << strategyName(m.second) << "," << m.games << ","
+            << 100.0 * m.outcomes[1] / n << "," << 100.0 * m.outcomes[2] / n << ","
+            << 100.0 * m.outcomes[0] / n << "," << m.turns / n;
+        for (int k = 0; k < 2; ++k) {
+            double shots = qMax<qint64>(1, m.shots[k]);
+            out << "," << m.damageMilli[k] / 1000.0 / shots;
+        }
+        out << ",";
+        for (int k = 0; k < damageBins; ++k) {
+            if (m.damageHistogram[k] == 0) continue;
+            out << " " << k * damageBinWidth << ":" << m.damageHistogram[k];
+        }
+        out << "\n";
+    }
+}
+
+int runTournament(const QStringList& args)
+{
+    Tournament tournament;
+    tournament.setGamesPerMatchup(optionValue(args, "--games", "1000").toInt());
+    tournament.setThreadCount(optionValue(args, "--threads", "1").toInt());
+    tournament.setSeed(optionValue(args, "--seed", "12345").toUInt());
+    tournament.setMaxTurns(optionValue(args, "--max-turns", "200").toInt());
+
+    const QStringList layouts = optionValue(args, "--layouts", "clasico").split(',');
+    const QStringList damages = optionValue(args, "--damage", "0.5").split(',');
+    const QStringList restitutions = optionValue(args, "--restitution", "0.6").split(',');
+
+    for (const QString& layout : layouts) {
+        TournamentConfig config;
+        if (!Tournament::builtInLayout(layout, config)) {
+            qWarning() << "Mapa desconocido:" << layout;
+            return 1;
+        }
+        for (const QString& damage : damages) {
+            for (const QString& restitution : restitutions) {
+                config.damageFactor = damage.toDouble();
+                config.restitutionCoefficient = restitution.toDouble();
+                tournament.addConfiguration(config);
+            }
+        }
+    }
+
+    for (const QString& name : optionValue(args, "--strategies", "random,sweep,aimed").split(',')) {
+        if (name == "random") {
+            tournament.addStrategy(RandomStrategy);
+        } else if (name == "sweep") {
+            tournament.addStrategy(SweepStrategy);
+        } else if (name == "aimed") {
+            tournament.addStrategy(AimedStrategy);
+        } else {
+            qWarning() << "Estrategia desconocida:" << name;
+            return 1;
+        }
+    }
+
+    tournament.run();
+
+    QString reportFile = optionValue(args, "--report", QString());
+    if (reportFile.isEmpty()) {
+        QTextStream out(stdout);
+        tournament.writeReport(out);
+        return 0;
+    }
+
+    QFile file(reportFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "No se pudo abrir el archivo de reporte:" << reportFile;
+        return 1;
+    }
+    QTextStream out(&file);
+    tournament.writeReport(out);
+    return 0;
+}
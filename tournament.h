@@ -0,0 +1,104 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include "gameengine.h"
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+// Estrategias de tiro del autojuego
+enum ShotStrategy {
+    RandomStrategy,   // ángulo y velocidad uniformes en el rango de la interfaz
+    SweepStrategy,    // guion fijo que recorre el rango turno a turno
+    AimedStrategy     // el mejor de varios tiros al azar según predictTrajectory
+};
+
+// Mapa y parámetros de balance de una configuración
+struct TournamentConfig {
+    QString layout;
+    double damageFactor;
+    double restitutionCoefficient;
+    QVector<Infrastructure> player1;
+    QVector<Infrastructure> player2;
+};
+
+// Resultado acumulado de una configuración con una pareja de estrategias.
+// Solo hay contadores enteros (el daño en milésimas), así que la suma de
+// los parciales de cada hilo no depende del orden ni del número de hilos.
+struct MatchupResult {
+    int config;
+    ShotStrategy first;       // juega como jugador 1 (abre la partida)
+    ShotStrategy second;
+    qint64 games;
+    qint64 outcomes[3];       // empates por límite de turnos, victorias J1, victorias J2
+    qint64 turns;
+    qint64 shots[2];          // disparos por jugador
+    qint64 damageMilli[2];    // resistencia quitada por jugador, en milésimas
+    qint64 damageHistogram[16];   // daño por disparo (ver Tournament::damageBinWidth)
+};
+
+// Torneo de autojuego sin interfaz: cada partida se juega de principio a
+// fin con GameEngine::playShot (un disparo completo por llamada, sin pasos
+// de 16 ms) y las partidas se reparten entre los hilos de un WorkerPool.
+// Cada partida usa su propia semilla derivada de (semilla, enfrentamiento,
+// número de partida): el resultado es el mismo con cualquier número de hilos.
+class Tournament
+{
+public:
+    Tournament();
+
+    // Mismo paso de tiempo que el temporizador de MainWindow
+    static constexpr double frameStep = 0.016;
+
+    static const int damageBins = 16;
+    static constexpr double damageBinWidth = 25.0;   // el último bin es abierto
+
+    void addConfiguration(const TournamentConfig& config) { configs.append(config); }
+    void addStrategy(ShotStrategy strategy) { strategies.append(strategy); }
+    void setGamesPerMatchup(int games) { gamesPerMatchup = qMax(1, games); }
+    void setMaxTurns(int turns) { maxTurns = qMax(1, turns); }
+    void setSeed(unsigned int value) { seed = value; }
+    void setThreadCount(int threads) { threadCount = qMax(1, threads); }
+
+    // Juega todas las parejas ordenadas de estrategias en cada configuración
+    void run();
+
+    const QVector<MatchupResult>& results() const { return matchups; }
+    qint64 gamesPlayed() const;
+    double elapsedSeconds() const { return elapsed; }
+
+    // Un renglón CSV por enfrentamiento, con encabezado "# ..."
+    void writeReport(QTextStream& out) const;
+
+    static QString strategyName(ShotStrategy strategy);
+
+    // Mapas predefinidos: "clasico" (el de MainWindow), "muro" y "torres"
+    static bool builtInLayout(const QString& name, TournamentConfig& config);
+
+private:
+    QVector<TournamentConfig> configs;
+    QVector<ShotStrategy> strategies;
+    QVector<MatchupResult> matchups;
+    int gamesPerMatchup;
+    int maxTurns;
+    unsigned int seed;
+    int threadCount;
+    double elapsed;
+
+    void playGame(int matchup, qint64 game, MatchupResult& tally) const;
+};
+
+// Modo de línea de comandos:
+//
+//   practica5 --tournament [--games N] [--threads H] [--seed S] [--max-turns T]
+//                          [--layouts clasico,muro,torres] [--damage 0.3,0.5]
+//                          [--restitution 0.4,0.6] [--strategies random,sweep,aimed]
+//                          [--report archivo]
+//
+// Se juega el producto de mapas, factores de daño y coeficientes de
+// restitución; cada configuración enfrenta todas las parejas ordenadas de
+// estrategias N veces. El reporte va a la salida estándar o a --report.
+int runTournament(const QStringList& args);
+
+#endif // TOURNAMENT_H
@@ -0,0 +1,68 @@
+#include "workerpool.h"
+
+WorkerPool::WorkerPool(int threads)
+    : threadCount(qMax(1, threads)), current(nullptr), generation(0),
+    pending(0), stopping(false)
+{
+    for (int i = 1; i < threadCount; ++i) {
+        workers.emplace_back(&WorkerPool::workerLoop, this, i);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+}
+
+void WorkerPool::run(const std::function<void(int)>& task)
+{
+    if (threadCount == 1) {
+        task(0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = &task;
+        pending = threadCount - 1;
+        generation++;
+    }
+    wake.notify_all();
+
+    // El hilo llamador también trabaja
+    task(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return pending == 0; });
+    current = nullptr;
+}
+
+void WorkerPool::workerLoop(int index)
+{
+    quint64 seen = 0;
+
+    for (;;) {
+        const std::function<void(int)>* task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            task = current;
+        }
+
+        (*task)(index);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) {
+            done.notify_one();
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <QtGlobal>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Grupo fijo de hilos reutilizado en cada paso de la simulación.
+// run(task) ejecuta task(índiceDeHilo) en todos los hilos, incluido el
+// llamador como hilo 0, y regresa cuando todos terminaron. El reparto del
+// trabajo (bloques) lo decide la tarea.
+class WorkerPool
+{
+public:
+    explicit WorkerPool(int threadCount);
+    ~WorkerPool();
+
+    int size() const { return threadCount; }
+
+    void run(const std::function<void(int)>& task);
+
+private:
+    int threadCount;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(int)>* current;
+    quint64 generation;
+    int pending;
+    bool stopping;
+
+    void workerLoop(int index);
+
+    WorkerPool(const WorkerPool&);
+    WorkerPool& operator=(const WorkerPool&);
+};
+
+#endif // WORKERPOOL_H